@@ -0,0 +1,138 @@
+/**
+ * CPDSA: Aho-Corasick automaton -*- C++ -*-
+ *
+ * @file include/cpdsa/src/aho_corasick.hpp
+ */
+
+#ifndef CPDSA_AHO_CORASICK
+#define CPDSA_AHO_CORASICK
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>  // for std::uint32_t
+#include <cstdio>   // for std::FILE, std::fread
+#include <ranges>
+#include <string_view>
+#include <vector>
+
+#include "base/aho_corasick_base.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief A dictionary of byte strings, finding all their occurrences in a
+ * text in one pass.
+ *
+ * @note Patterns are numbered in the order they were given, and must not be
+ * empty (or @c std::invalid_argument is thrown). Building takes
+ * @a O(L * classes), where @a L is their total length and @a classes the
+ * number of distinct bytes in them, plus one; so does the memory, as 4-byte
+ * entries (see @c aho_corasick_base), which must number less than 2^31 (or
+ * @c std::length_error is thrown). Matching then takes @a O(1) per byte,
+ * plus the matches reported.
+ *
+ * @note Texts may come in pieces: @c feed returns the state to continue the
+ * next piece from, and @c scan streams a whole file this way.
+ */
+class aho_corasick : private aho_corasick_base {
+   private:
+    using Base_type = aho_corasick_base;
+
+   public:
+    using state_type = Base_type::state_type;
+    using size_type = Base_type::size_type;
+
+    /**
+     * @brief The state before any byte is read.
+     */
+    static constexpr state_type START = 0;
+
+    /**
+     * @brief Create the automaton of the strings in @c patterns, which are
+     * read twice.
+     */
+    template <std::ranges::forward_range _Range>
+        requires std::convertible_to<std::ranges::range_reference_t<_Range>,
+                                     std::string_view>
+    explicit aho_corasick(const _Range& patterns) {
+        for (std::string_view pattern : patterns)
+            this->map_bytes(pattern);
+        this->add_state();
+        std::uint32_t id = 0;
+        for (std::string_view pattern : patterns)
+            this->insert(pattern, id++);
+        this->complete();
+    }
+
+    [[nodiscard]] size_type pattern_count() const noexcept {
+        return this->same_as.size();
+    }
+
+    [[nodiscard]] size_type state_count() const noexcept {
+        return Base_type::state_count();
+    }
+
+    /**
+     * @brief Read @c text from @c state, calling @c report(pattern, end)
+     * for each occurrence of a pattern ending just before @c text[end].
+     *
+     * @return The state after @c text.
+     */
+    template <typename _Callback>
+    state_type feed(std::string_view text, state_type state,
+                    _Callback&& report) const {
+        const state_type* delta = this->delta.data();
+        for (size_type i = 0; i < text.size(); ++i) {
+            state = delta[state + this->classes[(unsigned char)text[i]]];
+            if (state < 0) [[unlikely]] {
+                state = ~state;
+                auto at = [&report, i](std::uint32_t p) { report(p, i + 1); };
+                this->report_all(state, at);
+            }
+        }
+        return state;
+    }
+
+    /**
+     * @brief Returns the number of occurrences of patterns in @c text.
+     */
+    [[nodiscard]] size_type count(std::string_view text) const noexcept {
+        const state_type* delta = this->delta.data();
+        state_type state = START;
+        size_type result = 0;
+        for (unsigned char c : text) {
+            state = delta[state + this->classes[c]];
+            if (state < 0) [[unlikely]] {
+                state = ~state;
+                result += this->match_count[state / this->class_count];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief Read @c file to its end, in blocks of 64 KB like
+     * @c buffer_scan, calling @c report(pattern, end) for each occurrence
+     * of a pattern ending just before byte @c end of what was read.
+     *
+     * @return The number of bytes read.
+     */
+    template <typename _Callback>
+    size_type scan(_Callback&& report, std::FILE* file = stdin) const {
+        static constexpr size_type BUFSIZE = 1 << 16;
+        std::vector<char> buf(BUFSIZE);
+        state_type state = START;
+        size_type read = 0;
+        for (size_type got; (got = std::fread(buf.data(), 1, BUFSIZE, file));
+             read += got)
+            state = feed({buf.data(), got}, state,
+                         [&report, read](std::uint32_t p, size_type end) {
+                             report(p, read + end);
+                         });
+        return read;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_AHO_CORASICK */
@@ -0,0 +1,150 @@
+/**
+ * CPDSA: Aho-Corasick automaton, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/aho_corasick_base.hpp
+ */
+
+#ifndef CPDSA_AHO_CORASICK_BASE
+#define CPDSA_AHO_CORASICK_BASE
+
+#include <array>
+#include <cstddef>
+#include <cstdint>  // for std::int32_t, std::uint32_t, std::uint16_t
+#include <limits>
+#include <stdexcept>  // for std::invalid_argument, std::length_error
+#include <string_view>
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for aho_corasick.
+ *
+ * @note Bytes are first mapped to classes: one per byte occurring in some
+ * pattern, and class 0 for all others, which always lead back to the root.
+ * The automaton is then a complete DFA, stored as one flat table of
+ * @a states * @a classes entries: reading a byte costs one lookup in
+ * @a classes and one in @a delta, with no failure links to follow.
+ *
+ * @note Entries of @a delta hold the offset of the target's row rather than
+ * its number, so that no multiplication is needed, and its bitwise
+ * complement when some pattern ends at the target: the hot loop only tests
+ * a sign, and reports matches from the rare states where one ends.
+ *
+ * @note The trie is built in the table itself, 0 marking missing children
+ * (the root is nobody's child). A breadth-first search then computes the
+ * failure link @a f of each state @a s and completes its row, every missing
+ * child of @a s being the corresponding child of @a f, whose row is already
+ * complete since @a f is shallower.
+ */
+class aho_corasick_base {
+   protected:
+    using state_type = std::int32_t;
+    using size_type = std::size_t;
+
+    static constexpr std::uint32_t NONE = -1;
+
+    // 16 bits: with every byte in some pattern, there are 257 classes
+    std::array<std::uint16_t, 256> classes{};
+    size_type class_count = 1;
+    std::vector<state_type> delta;
+    // per state (by number): the first pattern ending there, the nearest
+    // proper suffix where one does, and how many end there or at a suffix
+    std::vector<std::uint32_t> terminal, dictionary_link;
+    std::vector<size_type> match_count;
+    // the next pattern equal to each one
+    std::vector<std::uint32_t> same_as;
+
+    [[nodiscard]] size_type state_count() const noexcept {
+        return terminal.size();
+    }
+
+    state_type add_state() {
+        // row offsets, and their complements, must fit in a state_type
+        if (delta.size() + class_count >
+            std::size_t(std::numeric_limits<state_type>::max()))
+            throw std::length_error("aho_corasick: table over 2^31 entries");
+        delta.resize(delta.size() + class_count, 0);
+        terminal.push_back(NONE);
+        return state_type(terminal.size() - 1);
+    }
+
+    void map_bytes(std::string_view pattern) {
+        for (unsigned char c : pattern)
+            if (!classes[c])
+                classes[c] = class_count++;
+    }
+
+    void insert(std::string_view pattern, std::uint32_t id) {
+        if (pattern.empty())
+            throw std::invalid_argument("aho_corasick: empty pattern");
+        if (id == NONE)
+            throw std::length_error("aho_corasick: too many patterns");
+        state_type s = 0;
+        for (unsigned char c : pattern) {
+            const size_type at = s * class_count + classes[c];
+            if (!delta[at]) {
+                const state_type t = add_state();
+                delta[at] = t;
+            }
+            s = delta[at];
+        }
+        same_as.push_back(terminal[s]);
+        terminal[s] = id;
+    }
+
+    /**
+     * @brief Turn the trie into the DFA, and encode its entries.
+     */
+    void complete() {
+        const size_type n = state_count();
+        dictionary_link.assign(n, NONE);
+        match_count.assign(n, 0);
+        std::vector<state_type> fail(n, 0), queue;
+        queue.reserve(n);
+        queue.push_back(0);
+        for (size_type head = 0; head < queue.size(); ++head) {
+            const state_type s = queue[head];
+            const state_type f = fail[s];
+            if (s) {
+                dictionary_link[s] =
+                    terminal[f] != NONE ? f : dictionary_link[f];
+                match_count[s] = match_count[f];
+            }
+            for (std::uint32_t p = terminal[s]; p != NONE; p = same_as[p])
+                ++match_count[s];
+            state_type* row = delta.data() + s * class_count;
+            const state_type* fail_row = delta.data() + f * class_count;
+            for (size_type c = 0; c < class_count; ++c) {
+                const state_type t = row[c];
+                if (!t)
+                    row[c] = s ? fail_row[c] : 0;
+                else {
+                    fail[t] = s ? fail_row[c] : 0;
+                    queue.push_back(t);
+                }
+            }
+        }
+        for (state_type& t : delta)
+            t = match_count[t] ? ~state_type(t * class_count)
+                               : state_type(t * class_count);
+    }
+
+    /**
+     * @brief Call @c report(pattern) for every pattern ending at the state
+     * with row offset @c s.
+     */
+    template <typename _Callback>
+    void report_all(state_type s, _Callback& report) const {
+        std::uint32_t u = s / class_count;
+        if (terminal[u] == NONE)
+            u = dictionary_link[u];
+        for (; u != NONE; u = dictionary_link[u])
+            for (std::uint32_t p = terminal[u]; p != NONE; p = same_as[p])
+                report(p);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_AHO_CORASICK_BASE */
@@ -0,0 +1,613 @@
+/**
+ * CPDSA: Arbitrary-precision integer, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/bigint_base.hpp
+ */
+
+#ifndef CPDSA_BIGINT_BASE
+#define CPDSA_BIGINT_BASE
+
+#include <algorithm>  // for std::fill, std::max, std::min
+#include <bit>        // for std::bit_ceil, std::countl_zero
+#include <cassert>
+#include <cstddef>
+#include <cstdint>  // for std::uint64_t
+#include <string>
+#include <utility>  // for std::swap
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for bigint: unsigned arithmetic on
+ * magnitudes, stored as little-endian vectors of 64-bit limbs with no leading
+ * zero limb (zero is the empty vector).
+ *
+ * @note Multiplication is schoolbook below @c KARATSUBA_THRESHOLD limbs,
+ * Karatsuba below @c NTT_THRESHOLD, and a number-theoretic transform beyond
+ * that. The transform works modulo the prime @a 2^64 - 2^32 + 1 over 16-bit
+ * digits, whose convolutions fit below it for operands of up to @a 2^30
+ * limbs, so that one transform per operand is enough.
+ *
+ * @note Division is schoolbook (Knuth's algorithm D) when either the divisor
+ * or the quotient is short. Otherwise it multiplies by a reciprocal computed
+ * with Newton's iteration, which costs a few multiplications.
+ *
+ * @note Decimal conversion splits numbers by @a 10^(19 * 2^i) recursively, so
+ * that printing and parsing @a n digits take @a O(log(n)) multiplications of
+ * size up to @a n, instead of @a O(n^2) limb operations.
+ */
+class bigint_base {
+   protected:
+    using limb = std::uint64_t;
+    using wide = unsigned __int128;
+    using limbs = std::vector<limb>;
+
+    static constexpr std::size_t KARATSUBA_THRESHOLD = 32;
+    static constexpr std::size_t NTT_THRESHOLD = 4096;
+    static constexpr std::size_t NEWTON_THRESHOLD = 64;
+    static constexpr std::size_t CONVERSION_THRESHOLD = 32;
+
+    // the largest power of 10 in a limb, and its exponent
+    static constexpr limb TEN_POWER = 10000000000000000000ull;
+    static constexpr std::size_t TEN_DIGITS = 19;
+
+    limbs mag;
+    bool negative = false;
+
+    static void trim(limbs& a) noexcept {
+        while (!a.empty() && !a.back())
+            a.pop_back();
+    }
+
+    /**
+     * @brief Returns -1, 0 or 1 as @c a is less than, equal to or greater
+     * than @c b.
+     */
+    [[nodiscard]] static int compare(const limbs& a, const limbs& b) noexcept {
+        if (a.size() != b.size())
+            return a.size() < b.size() ? -1 : 1;
+        for (std::size_t i = a.size(); i--;)
+            if (a[i] != b[i])
+                return a[i] < b[i] ? -1 : 1;
+        return 0;
+    }
+
+    /**
+     * @brief Adds the @c an limbs of @c a to the @c rn limbs of @c r, with
+     * @c an <= @c rn.
+     *
+     * @return The carry out of @c r.
+     */
+    static limb add_into(limb* r, std::size_t rn, const limb* a,
+                         std::size_t an) noexcept {
+        limb carry = 0;
+        std::size_t i = 0;
+        for (; i < an; ++i) {
+            const limb s = r[i] + carry;
+            carry = s < carry;
+            r[i] = s + a[i];
+            carry += r[i] < a[i];
+        }
+        for (; carry && i < rn; ++i)
+            carry = ++r[i] == 0;
+        return carry;
+    }
+
+    /**
+     * @brief Subtracts the @c an limbs of @c a from the @c rn limbs of @c r,
+     * with @c an <= @c rn.
+     *
+     * @return The borrow out of @c r.
+     */
+    static limb sub_into(limb* r, std::size_t rn, const limb* a,
+                         std::size_t an) noexcept {
+        limb borrow = 0;
+        std::size_t i = 0;
+        for (; i < an; ++i) {
+            const limb t = r[i] - a[i];
+            const limb next = (r[i] < a[i]) | (t < borrow);
+            r[i] = t - borrow;
+            borrow = next;
+        }
+        for (; borrow && i < rn; ++i)
+            borrow = r[i]-- == 0;
+        return borrow;
+    }
+
+    /**
+     * @brief @c a += @c b.
+     */
+    static void add(limbs& a, const limbs& b) {
+        if (a.size() < b.size())
+            a.resize(b.size());
+        if (add_into(a.data(), a.size(), b.data(), b.size()))
+            a.push_back(1);
+    }
+
+    /**
+     * @brief @c a -= @c b, for @c a not less than @c b.
+     */
+    static void sub(limbs& a, const limbs& b) noexcept {
+        sub_into(a.data(), a.size(), b.data(), b.size());
+        trim(a);
+    }
+
+    /**
+     * @brief @c a = @c a * @c m + @c c.
+     */
+    static void mul_small(limbs& a, limb m, limb c) {
+        for (limb& x : a) {
+            const wide t = (wide)x * m + c;
+            x = (limb)t;
+            c = t >> 64;
+        }
+        if (c)
+            a.push_back(c);
+    }
+
+    /**
+     * @brief @c a /= @c d.
+     *
+     * @return The remainder.
+     */
+    static limb div_small(limbs& a, limb d) noexcept {
+        wide rem = 0;
+        for (std::size_t i = a.size(); i--;) {
+            const wide t = rem << 64 | a[i];
+            a[i] = t / d;
+            rem = t % d;
+        }
+        trim(a);
+        return rem;
+    }
+
+    /**
+     * @brief Drops the @c k lowest limbs of @c a.
+     */
+    static void shift_down(limbs& a, std::size_t k) {
+        a.erase(a.begin(), a.begin() + std::min(k, a.size()));
+    }
+
+    // number-theoretic transform modulo 2^64 - 2^32 + 1, with generator 7
+    static constexpr limb MOD = 0xffffffff00000001ull;
+    static constexpr limb EPSILON = 0xffffffffull;  // 2^64 mod MOD
+    static constexpr limb GENERATOR = 7;
+
+    /**
+     * @brief Reduces a 128-bit number modulo @c MOD, using 2^64 = 2^32 - 1
+     * and 2^96 = -1.
+     */
+    [[nodiscard]] static limb mod_reduce(wide x) noexcept {
+        const limb lo = x, hi = x >> 64;
+        const limb hi_hi = hi >> 32, hi_lo = hi & EPSILON;
+        limb t = lo - hi_hi;
+        t -= EPSILON & -(limb)(lo < hi_hi);
+        const limb u = hi_lo * EPSILON;
+        limb r = t + u;
+        r += EPSILON & -(limb)(r < u);
+        return r - (MOD & -(limb)(r >= MOD));
+    }
+
+    [[nodiscard]] static limb mod_mul(limb a, limb b) noexcept {
+        return mod_reduce((wide)a * b);
+    }
+
+    // branch-free, as transform data is random
+    [[nodiscard]] static limb mod_add(limb a, limb b) noexcept {
+        limb s = a + b;
+        s += EPSILON & -(limb)(s < a);
+        return s - (MOD & -(limb)(s >= MOD));
+    }
+
+    [[nodiscard]] static limb mod_sub(limb a, limb b) noexcept {
+        return a - b - (EPSILON & -(limb)(a < b));
+    }
+
+    [[nodiscard]] static limb mod_pow(limb a, limb e) noexcept {
+        limb result = 1;
+        for (; e; e >>= 1, a = mod_mul(a, a))
+            if (e & 1)
+                result = mod_mul(result, a);
+        return result;
+    }
+
+    static void ntt(limbs& f, bool inverse) {
+        const std::size_t n = f.size();
+        for (std::size_t i = 1, j = 0; i < n; ++i) {
+            std::size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+                j ^= bit;
+            j ^= bit;
+            if (i < j)
+                std::swap(f[i], f[j]);
+        }
+        limbs w(std::max<std::size_t>(n / 2, 1));
+        for (std::size_t len = 1; len < n; len <<= 1) {
+            limb root = mod_pow(GENERATOR, (MOD - 1) / (2 * len));
+            if (inverse)
+                root = mod_pow(root, MOD - 2);
+            w[0] = 1;
+            for (std::size_t j = 1; j < len; ++j)
+                w[j] = mod_mul(w[j - 1], root);
+            for (std::size_t i = 0; i < n; i += 2 * len)
+                for (std::size_t j = 0; j < len; ++j) {
+                    const limb u = f[i + j];
+                    const limb v = mod_mul(f[i + j + len], w[j]);
+                    f[i + j] = mod_add(u, v);
+                    f[i + j + len] = mod_sub(u, v);
+                }
+        }
+    }
+
+    static void mul_ntt(const limb* a, std::size_t n, const limb* b,
+                        std::size_t m, limb* out) {
+        const bool square = a == b && n == m;
+        const std::size_t size = std::bit_ceil(4 * (n + m));
+        limbs fa(size), fb;
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t k = 0; k < 4; ++k)
+                fa[4 * i + k] = a[i] >> (16 * k) & 0xffff;
+        ntt(fa, false);
+        if (!square) {
+            fb.assign(size, 0);
+            for (std::size_t i = 0; i < m; ++i)
+                for (std::size_t k = 0; k < 4; ++k)
+                    fb[4 * i + k] = b[i] >> (16 * k) & 0xffff;
+            ntt(fb, false);
+        }
+        const limb scale = mod_pow(size, MOD - 2);
+        for (std::size_t i = 0; i < size; ++i)
+            fa[i] = mod_mul(mod_mul(fa[i], square ? fa[i] : fb[i]), scale);
+        ntt(fa, true);
+        wide carry = 0;
+        for (std::size_t i = 0; i < n + m; ++i) {
+            limb x = 0;
+            for (std::size_t k = 0; k < 4; ++k) {
+                carry += fa[4 * i + k];
+                x |= (limb)(carry & 0xffff) << (16 * k);
+                carry >>= 16;
+            }
+            out[i] = x;
+        }
+    }
+
+    static void mul_basecase(const limb* a, std::size_t n, const limb* b,
+                             std::size_t m, limb* out) noexcept {
+        std::fill(out, out + n + m, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            limb carry = 0;
+            for (std::size_t j = 0; j < m; ++j) {
+                const wide t = (wide)a[i] * b[j] + out[i + j] + carry;
+                out[i + j] = t;
+                carry = t >> 64;
+            }
+            out[i + m] = carry;
+        }
+    }
+
+    /**
+     * @brief Splits both operands at @c h limbs, with @c h < @c m <= @c n,
+     * and gets the middle product out of the sums of the halves.
+     */
+    static void mul_karatsuba(const limb* a, std::size_t n, const limb* b,
+                              std::size_t m, limb* out) {
+        const bool square = a == b && n == m;
+        const std::size_t h = (n + 1) / 2;
+        mul(a, h, b, h, out);
+        mul(a + h, n - h, b + h, m - h, out + 2 * h);
+        limbs sa(a, a + h + 1), sb;
+        sa[h] = add_into(sa.data(), h, a + h, n - h);
+        if (!square) {
+            sb.assign(b, b + h + 1);
+            sb[h] = add_into(sb.data(), h, b + h, m - h);
+        }
+        limbs mid(2 * h + 2);
+        mul(sa.data(), h + 1, (square ? sa : sb).data(), h + 1, mid.data());
+        sub_into(mid.data(), mid.size(), out, 2 * h);
+        sub_into(mid.data(), mid.size(), out + 2 * h, n + m - 2 * h);
+        trim(mid);
+        add_into(out + h, n + m - h, mid.data(), mid.size());
+    }
+
+    /**
+     * @brief Writes the @c n + @c m limbs of @c a * @c b into @c out, which
+     * must not overlap the operands.
+     */
+    static void mul(const limb* a, std::size_t n, const limb* b,
+                    std::size_t m, limb* out) {
+        if (n < m) {
+            std::swap(a, b);
+            std::swap(n, m);
+        }
+        if (m < KARATSUBA_THRESHOLD) {
+            mul_basecase(a, n, b, m, out);
+        } else if (m >= NTT_THRESHOLD) {
+            mul_ntt(a, n, b, m, out);
+        } else if (2 * m <= n + 1) {
+            // too unbalanced to split both: multiply m limbs of a at a time
+            std::fill(out, out + n + m, 0);
+            limbs part(2 * m);
+            for (std::size_t i = 0; i < n; i += m) {
+                const std::size_t k = std::min(m, n - i);
+                mul(a + i, k, b, m, part.data());
+                add_into(out + i, n + m - i, part.data(), k + m);
+            }
+        } else {
+            mul_karatsuba(a, n, b, m, out);
+        }
+    }
+
+    [[nodiscard]] static limbs multiply(const limbs& a, const limbs& b) {
+        if (a.empty() || b.empty())
+            return {};
+        limbs result(a.size() + b.size());
+        mul(a.data(), a.size(), b.data(), b.size(), result.data());
+        trim(result);
+        return result;
+    }
+
+    /**
+     * @brief Knuth's algorithm D, for @c b of at least 2 limbs and @c a not
+     * less than @c b. Takes @a O((size(a) - size(b) + 1) * size(b)).
+     */
+    static void divmod_schoolbook(const limbs& a, const limbs& b, limbs& q,
+                                  limbs& r) {
+        const std::size_t n = a.size(), m = b.size();
+        assert(m >= 2 && n >= m);
+        const int s = std::countl_zero(b.back());
+        limbs u(n + 1), v(m);
+        for (std::size_t i = m; i--;)
+            v[i] = b[i] << s | (s && i ? b[i - 1] >> (64 - s) : 0);
+        for (std::size_t i = n; i--;)
+            u[i] = a[i] << s | (s && i ? a[i - 1] >> (64 - s) : 0);
+        u[n] = s ? a[n - 1] >> (64 - s) : 0;
+        q.assign(n - m + 1, 0);
+        for (std::size_t j = n - m + 1; j--;) {
+            const wide top = (wide)u[j + m] << 64 | u[j + m - 1];
+            wide qhat = top / v[m - 1], rhat = top % v[m - 1];
+            while (qhat >> 64 ||
+                   qhat * v[m - 2] > (rhat << 64 | u[j + m - 2])) {
+                --qhat;
+                rhat += v[m - 1];
+                if (rhat >> 64)
+                    break;
+            }
+            limb carry = 0, borrow = 0;
+            for (std::size_t i = 0; i < m; ++i) {
+                const wide p = qhat * v[i] + carry;
+                carry = p >> 64;
+                const limb t = u[i + j] - (limb)p;
+                const limb next = (u[i + j] < (limb)p) | (t < borrow);
+                u[i + j] = t - borrow;
+                borrow = next;
+            }
+            const limb t = u[j + m] - carry;
+            const bool negative_ = (u[j + m] < carry) | (t < borrow);
+            u[j + m] = t - borrow;
+            if (negative_) {  // qhat was one too large
+                --qhat;
+                u[j + m] += add_into(u.data() + j, m, v.data(), m);
+            }
+            q[j] = qhat;
+        }
+        r.assign(m, 0);
+        for (std::size_t i = 0; i < m; ++i)
+            r[i] = u[i] >> s | (s ? u[i + 1] << (64 - s) : 0);
+        trim(q);
+        trim(r);
+    }
+
+    /**
+     * @brief Returns about @a B^k / @c b, @a B being 2^64, for @c k not less
+     * than the size of @c b. Off by a few units at most.
+     *
+     * @note Only the top limbs of @c b matter for the result's precision, so
+     * they are all it looks at. Beyond @c NEWTON_THRESHOLD limbs, it first
+     * computes half as many limbs, then refines them with one Newton step
+     * @a x' = 2x - b * x^2 / B^k, which doubles their number.
+     */
+    [[nodiscard]] static limbs reciprocal(const limbs& b, std::size_t k) {
+        const std::size_t m = b.size(), l = k - m;
+        assert(m >= 2 && k >= m);
+        if (m > l + 2) {
+            const std::size_t d = m - (l + 2);
+            return reciprocal(limbs(b.begin() + d, b.end()), k - d);
+        }
+        if (l <= NEWTON_THRESHOLD) {
+            limbs power(k + 1), q, r;
+            power[k] = 1;
+            divmod_schoolbook(power, b, q, r);
+            return q;
+        }
+        const std::size_t h = l / 2 + 1, s = l - h;
+        const limbs y = reciprocal(b, k - s);
+        limbs correction = multiply(b, multiply(y, y));
+        shift_down(correction, k - 2 * s);
+        limbs first(s);
+        first.insert(first.end(), y.begin(), y.end());
+        limbs x = first;
+        add(x, first);
+        if (compare(x, correction) <= 0)
+            return first;  // can't happen with a sane first approximation
+        sub(x, correction);
+        return x;
+    }
+
+    /**
+     * @brief Divides with @c x, about @a B^k / @c b, for @c a of at most @c k
+     * limbs: the quotient is then off by a few units, fixed afterwards.
+     */
+    static void divmod_reciprocal(const limbs& a, const limbs& b,
+                                  const limbs& x, std::size_t k, limbs& q,
+                                  limbs& r) {
+        // limbs of a below b / B move the quotient by less than one
+        const std::size_t d = b.size() > 2 ? b.size() - 2 : 0;
+        q = d < a.size() ? multiply(limbs(a.begin() + d, a.end()), x) : limbs();
+        shift_down(q, k - d);
+        limbs qb = multiply(q, b);
+        const limbs one{1};
+        while (compare(qb, a) > 0) {
+            sub(q, one);
+            sub(qb, b);
+        }
+        r = a;
+        sub(r, qb);
+        while (compare(r, b) >= 0) {
+            sub(r, b);
+            add(q, one);
+        }
+    }
+
+    /**
+     * @brief @c q = @c a / @c b and @c r = @c a % @c b, for non-zero @c b.
+     */
+    static void divmod(const limbs& a, const limbs& b, limbs& q, limbs& r) {
+        if (compare(a, b) < 0) {
+            q.clear();
+            r = a;
+        } else if (b.size() == 1) {
+            q = a;
+            const limb rem = div_small(q, b[0]);
+            r.assign(rem != 0, rem);
+        } else if (b.size() <= NEWTON_THRESHOLD ||
+                   a.size() - b.size() <= NEWTON_THRESHOLD) {
+            divmod_schoolbook(a, b, q, r);
+        } else {
+            divmod_reciprocal(a, b, reciprocal(b, a.size()), a.size(), q, r);
+        }
+    }
+
+    /**
+     * @brief Returns @a 10^(19 * 2^i) for @a i below @c levels.
+     */
+    [[nodiscard]] static std::vector<limbs> ten_powers(std::size_t levels) {
+        std::vector<limbs> powers{{TEN_POWER}};
+        while (powers.size() < levels)
+            powers.push_back(multiply(powers.back(), powers.back()));
+        return powers;
+    }
+
+    /**
+     * @brief Writes exactly @c width digits of @c x, padded with zeros, by
+     * repeated short division.
+     */
+    static void write_small(limbs x, char* out, std::size_t width) {
+        std::fill(out, out + width, '0');
+        for (std::size_t end = width; !x.empty(); end -= TEN_DIGITS) {
+            std::size_t at = end;
+            for (limb chunk = div_small(x, TEN_POWER); chunk; chunk /= 10)
+                out[--at] = '0' + chunk % 10;
+        }
+    }
+
+    struct decimal_writer {
+        std::vector<limbs> powers, inverses;
+
+        /**
+         * @brief Writes exactly @a 19 * 2^i digits of @c x, which is less
+         * than @a powers[i].
+         */
+        void write_padded(const limbs& x, std::size_t i, char* out) const {
+            const std::size_t width = TEN_DIGITS << i;
+            if (x.size() <= CONVERSION_THRESHOLD)
+                return write_small(x, out, width);
+            limbs q, r;
+            divide(x, i - 1, q, r);
+            write_padded(q, i - 1, out);
+            write_padded(r, i - 1, out + width / 2);
+        }
+
+        /**
+         * @brief Appends the digits of non-zero @c x, less than
+         * @a powers[i]^2, without leading zeros.
+         */
+        void write(const limbs& x, std::size_t i, std::string& out) const {
+            if (x.size() <= CONVERSION_THRESHOLD) {
+                std::string digits(20 * x.size(), '0');
+                write_small(x, digits.data(), digits.size());
+                out.append(digits, digits.find_first_not_of('0'));
+                return;
+            }
+            while (compare(x, powers[i]) < 0)
+                --i;
+            limbs q, r;
+            divide(x, i, q, r);
+            write(q, i, out);
+            const std::size_t at = out.size();
+            out.resize(at + (TEN_DIGITS << i));
+            write_padded(r, i, out.data() + at);
+        }
+
+        void divide(const limbs& x, std::size_t i, limbs& q, limbs& r) const {
+            if (inverses[i].empty())  // a single limb: short division
+                return divmod(x, powers[i], q, r);
+            divmod_reciprocal(x, powers[i], inverses[i],
+                              2 * powers[i].size(), q, r);
+        }
+    };
+
+    /**
+     * @brief Returns the decimal digits of non-zero @c x.
+     */
+    [[nodiscard]] static std::string to_decimal(const limbs& x) {
+        decimal_writer writer;
+        writer.powers = ten_powers(1);
+        while (2 * writer.powers.back().size() - 1 <= x.size())
+            writer.powers.push_back(
+                multiply(writer.powers.back(), writer.powers.back()));
+        // the one before is then enough to split x in two
+        if (writer.powers.size() > 1 && compare(writer.powers.back(), x) > 0)
+            writer.powers.pop_back();
+        for (const limbs& p : writer.powers)
+            writer.inverses.push_back(p.size() < 2 ? limbs()
+                                                   : reciprocal(p, 2 * p.size()));
+        std::string result;
+        writer.write(x, writer.powers.size() - 1, result);
+        return result;
+    }
+
+    /**
+     * @brief Returns the number spelled by the @c len decimal digits at
+     * @c digits.
+     */
+    [[nodiscard]] static limbs from_decimal(const char* digits, std::size_t len,
+                                            const std::vector<limbs>& powers) {
+        if (len <= TEN_DIGITS * CONVERSION_THRESHOLD) {
+            limbs x;
+            for (std::size_t i = 0; i < len;) {
+                const std::size_t k = i ? TEN_DIGITS : (len - 1) % TEN_DIGITS + 1;
+                limb chunk = 0, scale = 1;
+                for (std::size_t j = 0; j < k; ++j, ++i) {
+                    chunk = chunk * 10 + (digits[i] - '0');
+                    scale *= 10;
+                }
+                mul_small(x, scale, chunk);
+            }
+            trim(x);
+            return x;
+        }
+        std::size_t i = powers.size() - 1;
+        while ((TEN_DIGITS << i) >= len)
+            --i;
+        const std::size_t low_len = TEN_DIGITS << i;
+        limbs x = multiply(from_decimal(digits, len - low_len, powers),
+                           powers[i]);
+        const limbs low = from_decimal(digits + len - low_len, low_len, powers);
+        add(x, low);
+        trim(x);
+        return x;
+    }
+
+    [[nodiscard]] static limbs from_decimal(const char* digits,
+                                            std::size_t len) {
+        std::size_t levels = 1;
+        while ((TEN_DIGITS << levels) < len)
+            ++levels;
+        return from_decimal(digits, len, ten_powers(levels));
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_BIGINT_BASE */
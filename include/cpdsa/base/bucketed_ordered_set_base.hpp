@@ -0,0 +1,458 @@
+/**
+ * CPDSA: Leaf-bucketed ordered set, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/bucketed_ordered_set_base.hpp
+ */
+
+#ifndef CPDSA_BUCKETED_ORDERED_SET_BASE
+#define CPDSA_BUCKETED_ORDERED_SET_BASE
+
+#include <algorithm>  // for std::copy, std::min, std::max
+#include <concepts>   // for std::integral
+#include <memory>     // for std::unique_ptr
+#include <numeric>    // for std::midpoint
+#include <vector>
+
+#include "ordered_set_base.hpp"  // for ordered_set_sum_type
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for bucketed_ordered_set.
+ *
+ * @note The same dynamic segment tree as @c ordered_set_base, except that a
+ * subtree holding at most @a _Bucket elements is collapsed into a single node
+ * owning a sorted block of them. A block is only split into children when it
+ * overflows, and children are merged back into a block once their parent
+ * holds no more than half a block. Nodes of single-value ranges keep counting
+ * copies of their value, like in @c ordered_set_base.
+ */
+template <std::integral _Tp, _Tp LB, _Tp RB, size_t _Bucket>
+class bucketed_ordered_set_base {
+   private:
+    static_assert(_Bucket >= 2, "buckets must hold at least two elements");
+
+    static const int NULL_NODE_COUNT = 0;
+    static const int NULL_NODE_SUM = 0;
+    static constexpr _Tp NULL_NODE_MIN = RB;
+    static constexpr _Tp NULL_NODE_MAX = LB;
+
+    static const int EMPTY_NODE_COUNT = 0;
+    static const int EMPTY_NODE_SUM = 0;
+    static constexpr _Tp EMPTY_NODE_MIN = RB;
+    static constexpr _Tp EMPTY_NODE_MAX = LB;
+
+    std::nullptr_t NULL_NODE;
+
+    using sum_type = ordered_set_sum_type<_Tp>;
+
+    /**
+     * @brief Sorted elements of a collapsed subtree.
+     */
+    struct bucket {
+        _Tp values[_Bucket];
+    };
+
+    /**
+     * @brief Node implementation.
+     */
+    struct node {
+        int cnt;            // the amount of elements currently in the node ...
+        sum_type sum;       // ... and their sum.
+        _Tp lowest_value;   // Value bounds for the node.
+        _Tp highest_value;  // An empty node has lowest_value = RB and
+                            // highest_value = LB as obvious placeholders.
+        std::unique_ptr<node> left_child;
+        std::unique_ptr<node> right_child;  // left and right child
+        std::unique_ptr<bucket> block;      // the first cnt values, if this
+                                            // node is a collapsed subtree
+
+        node()
+            : cnt(EMPTY_NODE_COUNT),
+              sum(EMPTY_NODE_SUM),
+              lowest_value(EMPTY_NODE_MIN),
+              highest_value(EMPTY_NODE_MAX) {}
+
+        bool out_of_bound(_Tp u, _Tp v) const noexcept {
+            return (highest_value < u || v < lowest_value);
+        }
+
+        bool contained_by(_Tp u, _Tp v) const noexcept {
+            return (u <= lowest_value && highest_value <= v);
+        }
+    };
+
+    /**
+     * @brief Returns the number of values in a block less than @c val.
+     *
+     * @note A branchless scan over at most @a _Bucket values, which compilers
+     * vectorize.
+     */
+    [[nodiscard]] static size_t rank_in_block(const node& id,
+                                              const _Tp& val) noexcept {
+        size_t result = 0;
+        for (int i = 0; i < id.cnt; ++i)
+            result += id.block->values[i] < val;
+        return result;
+    }
+
+    /**
+     * @brief Refresh the aggregates of a collapsed node from its block.
+     */
+    static void update_from_block(node& id) noexcept {
+        id.sum = 0;
+        for (int i = 0; i < id.cnt; ++i)
+            id.sum += id.block->values[i];
+        id.lowest_value = id.cnt ? id.block->values[0] : EMPTY_NODE_MIN;
+        id.highest_value = id.cnt ? id.block->values[id.cnt - 1] : EMPTY_NODE_MAX;
+    }
+
+    /**
+     * @brief Append every element of a subtree, in order, to @c out.
+     */
+    static void collect(const node& id,
+                        const _Tp& l,
+                        const _Tp& r,
+                        std::vector<_Tp>& out) {
+        if (id.block) {
+            out.insert(out.end(), id.block->values, id.block->values + id.cnt);
+            return;
+        }
+        if (l == r) {
+            out.insert(out.end(), static_cast<size_t>(id.cnt), l);
+            return;
+        }
+        _Tp mid = std::midpoint(l, r);
+        if (id.left_child != nullptr)
+            collect(*(id.left_child), l, mid, out);
+        if (id.right_child != nullptr)
+            collect(*(id.right_child), mid + 1, r, out);
+    }
+
+   protected:
+    // these should have been a simple enum but
+    // are also used by child classes so ...
+    enum NODE_UPDATE_ACTIONS { ADD_ONCE, REMOVE_ONCE, REMOVE_ALL };
+
+    node root;
+
+    bucketed_ordered_set_base() : root() {
+        root.block = std::make_unique<bucket>();
+    }
+
+    /**
+     * @brief Drop every node and reset the root to an empty block.
+     */
+    void reset() {
+        root = node();
+        root.block = std::make_unique<bucket>();
+    }
+
+    /**
+     * @brief Creates a new child covering `[l,r]`: an empty block, or a
+     * counting node if `l == r`.
+     */
+    [[nodiscard]] static std::unique_ptr<node> create_node(const _Tp& l,
+                                                           const _Tp& r) {
+        auto result = std::make_unique<node>();
+        if (l != r)
+            result->block = std::make_unique<bucket>();
+        return result;
+    }
+
+    [[nodiscard]] constexpr int get_cnt(
+        const std::unique_ptr<node>& id) const noexcept {
+        return id == NULL_NODE ? NULL_NODE_COUNT : id->cnt;
+    }
+
+    [[nodiscard]] constexpr sum_type get_sum(
+        const std::unique_ptr<node>& id) const noexcept {
+        return id == NULL_NODE ? NULL_NODE_SUM : id->sum;
+    }
+
+    [[nodiscard]] constexpr _Tp get_lowest(
+        const std::unique_ptr<node>& id) const noexcept {
+        return id == NULL_NODE ? NULL_NODE_MIN : id->lowest_value;
+    }
+
+    [[nodiscard]] constexpr _Tp get_highest(
+        const std::unique_ptr<node>& id) const noexcept {
+        return id == NULL_NODE ? NULL_NODE_MAX : id->highest_value;
+    }
+
+    /**
+     * @brief Update values of the current node by propagating from its childs.
+     */
+    constexpr void update_from_childs(node& id) {
+        id.cnt = get_cnt(id.left_child) + get_cnt(id.right_child);
+        id.sum = get_sum(id.left_child) + get_sum(id.right_child);
+        id.lowest_value =
+            std::min(get_lowest(id.left_child), get_lowest(id.right_child));
+        id.highest_value =
+            std::max(get_highest(id.left_child), get_highest(id.right_child));
+    }
+
+    /**
+     * @brief Apply @c action for @c val to a collapsed node.
+     *
+     * @return False if the block is full and must be split first.
+     */
+    bool update_block(node& id, const _Tp& val, int action) {
+        _Tp* values = id.block->values;
+        size_t pos = rank_in_block(id, val);
+        switch (action) {
+            case NODE_UPDATE_ACTIONS::ADD_ONCE:
+                if (id.cnt == static_cast<int>(_Bucket))
+                    return false;
+                std::copy_backward(values + pos, values + id.cnt,
+                                   values + id.cnt + 1);
+                values[pos] = val;
+                ++id.cnt;
+                break;
+            case NODE_UPDATE_ACTIONS::REMOVE_ONCE:
+            case NODE_UPDATE_ACTIONS::REMOVE_ALL: {
+                size_t end = pos;
+                while (end < static_cast<size_t>(id.cnt) && values[end] == val &&
+                       (end == pos ||
+                        action == NODE_UPDATE_ACTIONS::REMOVE_ALL))
+                    ++end;
+                std::copy(values + end, values + id.cnt, values + pos);
+                id.cnt -= static_cast<int>(end - pos);
+                break;
+            }
+            default:
+                break;
+        }
+        update_from_block(id);
+        return true;
+    }
+
+    /**
+     * @brief Recursively update the state of a node, and all its descendants
+     * containing @c val in the container.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param val Value being updated.
+     * @param action Action specified (see @c NODE_UPDATE_ACTIONS)
+     */
+    void update(node& id,
+                const _Tp& l,
+                const _Tp& r,
+                const _Tp& val,
+                int action) {
+        if (l == r) {
+            if (action == NODE_UPDATE_ACTIONS::ADD_ONCE)
+                ++id.cnt;
+            else if (id.cnt)
+                id.cnt = action == NODE_UPDATE_ACTIONS::REMOVE_ONCE ? id.cnt - 1
+                                                                    : 0;
+            id.sum = static_cast<sum_type>(id.cnt) * l;
+            id.lowest_value = id.cnt ? l : EMPTY_NODE_MIN;
+            id.highest_value = id.cnt ? l : EMPTY_NODE_MAX;
+            return;
+        }
+
+        if (id.block) {
+            if (update_block(id, val, action))
+                return;
+            // Full: push the block down into children and carry on below.
+            std::unique_ptr<bucket> old = std::move(id.block);
+            const int old_cnt = id.cnt;
+            id.cnt = 0;
+            for (int i = 0; i < old_cnt; ++i)
+                update(id, l, r, old->values[i],
+                       NODE_UPDATE_ACTIONS::ADD_ONCE);
+        }
+
+        const bool removing = action != NODE_UPDATE_ACTIONS::ADD_ONCE;
+        _Tp mid = std::midpoint(l, r);
+        std::unique_ptr<node>& child =
+            val <= mid ? id.left_child : id.right_child;
+        if (child == NULL_NODE) {
+            if (removing)
+                return;
+            child = val <= mid ? create_node(l, mid) : create_node(mid + 1, r);
+        }
+        if (val <= mid)
+            update(*child, l, mid, val, action);
+        else
+            update(*child, mid + 1, r, val, action);
+        if (child->cnt == 0)
+            child.reset();
+        update_from_childs(id);
+
+        // Collapse back into a block once well below capacity, so that
+        // churn doesn't leave long chains behind.
+        if (removing && id.cnt <= static_cast<int>(_Bucket / 2)) {
+            std::vector<_Tp> values;
+            values.reserve(id.cnt);
+            collect(id, l, r, values);
+            id.left_child.reset();
+            id.right_child.reset();
+            id.block = std::make_unique<bucket>();
+            std::copy(values.begin(), values.end(), id.block->values);
+            update_from_block(id);
+        }
+    }
+
+    /**
+     * @brief Returns the number of elements of a node in the range `[u,v]`.
+     */
+    [[nodiscard]] int get(const node& id,
+                          const _Tp& l,
+                          const _Tp& r,
+                          _Tp u,
+                          _Tp v) const {
+        if (id.cnt == 0 || id.out_of_bound(u, v))
+            return NULL_NODE_COUNT;
+        if (id.contained_by(u, v))
+            return id.cnt;
+        if (id.block) {
+            int result = 0;
+            for (int i = 0; i < id.cnt; ++i)
+                result += (u <= id.block->values[i]) & (id.block->values[i] <= v);
+            return result;
+        }
+
+        _Tp mid = std::midpoint(l, r);
+        int result = 0;
+        if (id.left_child != NULL_NODE)
+            result += get(*(id.left_child), l, mid, u, v);
+        if (id.right_child != NULL_NODE)
+            result += get(*(id.right_child), mid + 1, r, u, v);
+        return result;
+    }
+
+    /**
+     * @brief Returns the sum of the elements of a node in the range `[u,v]`.
+     */
+    [[nodiscard]] sum_type range_sum(const node& id,
+                                     const _Tp& l,
+                                     const _Tp& r,
+                                     _Tp u,
+                                     _Tp v) const {
+        if (id.cnt == 0 || id.out_of_bound(u, v))
+            return NULL_NODE_SUM;
+        if (id.contained_by(u, v))
+            return id.sum;
+        if (id.block) {
+            sum_type result = 0;
+            for (int i = 0; i < id.cnt; ++i) {
+                const _Tp& x = id.block->values[i];
+                result += (u <= x && x <= v) ? x : 0;
+            }
+            return result;
+        }
+
+        _Tp mid = std::midpoint(l, r);
+        sum_type result = 0;
+        if (id.left_child != NULL_NODE)
+            result += range_sum(*(id.left_child), l, mid, u, v);
+        if (id.right_child != NULL_NODE)
+            result += range_sum(*(id.right_child), mid + 1, r, u, v);
+        return result;
+    }
+
+    /**
+     * @brief Find the value of the k-th smallest (1-based) element in the
+     * given node, with @c k at most @c id.cnt.
+     */
+    [[nodiscard]] _Tp k_largest(const node& id,
+                                _Tp l,
+                                _Tp r,
+                                size_t k) const {
+        const node* cur = &id;
+        while (!cur->block && l != r) {
+            _Tp mid = std::midpoint(l, r);
+            size_t left_cnt = get_cnt(cur->left_child);
+            if (left_cnt >= k) {
+                cur = cur->left_child.get();
+                r = mid;
+            } else {
+                k -= left_cnt;
+                cur = cur->right_child.get();
+                l = mid + 1;
+            }
+        }
+        return cur->block ? cur->block->values[k - 1] : l;
+    }
+
+    /**
+     * @brief Find the smallest value in a node not less than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp lower_bound(const node& id,
+                                  const _Tp& l,
+                                  const _Tp& r,
+                                  const _Tp& val) const {
+        if (id.cnt == 0 || id.highest_value < val)
+            return NULL_NODE_MIN;
+        if (val <= id.lowest_value)
+            return id.lowest_value;
+        if (id.block)
+            return id.block->values[rank_in_block(id, val)];
+
+        _Tp mid = std::midpoint(l, r);
+        if (get_highest(id.left_child) >= val && get_cnt(id.left_child))
+            return lower_bound(*(id.left_child), l, mid, val);
+        return lower_bound(*(id.right_child), mid + 1, r, val);
+    }
+
+    /**
+     * @brief Find the largest value in a node not more than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp upper_bound(const node& id,
+                                  const _Tp& l,
+                                  const _Tp& r,
+                                  const _Tp& val) const {
+        if (id.cnt == 0 || val < id.lowest_value)
+            return NULL_NODE_MIN;
+        if (id.highest_value <= val)
+            return id.highest_value;
+        if (id.block) {
+            size_t upto = rank_in_block(id, val);
+            while (upto < static_cast<size_t>(id.cnt) &&
+                   id.block->values[upto] == val)
+                ++upto;
+            return id.block->values[upto - 1];
+        }
+
+        _Tp mid = std::midpoint(l, r);
+        if (get_cnt(id.right_child) && get_lowest(id.right_child) <= val)
+            return upper_bound(*(id.right_child), mid + 1, r, val);
+        return upper_bound(*(id.left_child), l, mid, val);
+    }
+
+    /**
+     * @brief Returns the number of nodes and blocks in the subtree of a node.
+     */
+    [[nodiscard]] static size_t count_nodes(const node& id,
+                                            size_t& blocks) noexcept {
+        size_t result = 1;
+        blocks += static_cast<bool>(id.block);
+        if (id.left_child != nullptr)
+            result += count_nodes(*(id.left_child), blocks);
+        if (id.right_child != nullptr)
+            result += count_nodes(*(id.right_child), blocks);
+        return result;
+    }
+
+    /**
+     * @brief Returns the size in bytes of one node and of one block.
+     */
+    [[nodiscard]] static constexpr size_t node_size() noexcept {
+        return sizeof(node);
+    }
+    [[nodiscard]] static constexpr size_t block_size() noexcept {
+        return sizeof(bucket);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_BUCKETED_ORDERED_SET_BASE */
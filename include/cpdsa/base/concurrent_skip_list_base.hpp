@@ -0,0 +1,436 @@
+/**
+ * CPDSA: Lock-free skip list, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/concurrent_skip_list_base.hpp
+ */
+
+#ifndef CPDSA_CONCURRENT_SKIP_LIST_BASE
+#define CPDSA_CONCURRENT_SKIP_LIST_BASE
+
+#include <atomic>
+#include <bit>  // for std::countr_zero
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Epoch-based memory reclamation, shared by every lock-free container.
+ *
+ * @note A thread reading shared nodes does so inside a @c guard, which
+ * announces the global epoch it started in. A node unlinked during epoch
+ * @a e is @c retire -d into a bag of its thread, and freed once the global
+ * epoch reaches @a e + 3: by then every thread has started a new critical
+ * section since the unlink, so none can still hold it. The epoch only moves
+ * on when every thread inside a critical section has announced the current
+ * one, which is checked every @c ADVANCE_PERIOD retirements.
+ */
+class epoch_domain {
+   private:
+    static constexpr std::size_t ADVANCE_PERIOD = 64;
+
+    struct retired {
+        void* p;
+        void (*deleter)(void*);
+    };
+
+    /**
+     * @brief Per-thread state. Records are never freed while the domain
+     * lives; a thread that exits leaves its record (and pending bags) to the
+     * next thread.
+     */
+    struct alignas(64) record {
+        std::atomic<std::uint64_t> announced{0};  // epoch << 1 | active
+        std::atomic<bool> in_use{true};
+        std::uint32_t depth = 0;  // of nested guards
+        std::uint64_t seen = 0;   // epoch of the current critical section
+        std::size_t retired_since_advance = 0;
+        std::vector<retired> bags[3];  // by epoch modulo 3
+        record* next = nullptr;
+    };
+
+    std::atomic<std::uint64_t> epoch{3};
+    std::atomic<record*> records{nullptr};
+
+    static void free_bag(std::vector<retired>& bag) {
+        for (const retired& r : bag)
+            r.deleter(r.p);
+        bag.clear();
+    }
+
+    record* acquire_record() {
+        for (record* r = records.load(std::memory_order_acquire); r;
+             r = r->next) {
+            bool expected = false;
+            if (r->in_use.compare_exchange_strong(expected, true))
+                return r;
+        }
+        record* r = new record;
+        r->next = records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(r->next, r,
+                                              std::memory_order_release))
+            ;
+        return r;
+    }
+
+    /**
+     * @brief Gives its record back when the thread exits.
+     */
+    struct thread_handle {
+        record* r = nullptr;
+        ~thread_handle() {
+            if (r)
+                r->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    record& local() {
+        thread_local thread_handle handle;
+        if (!handle.r)
+            handle.r = acquire_record();
+        return *handle.r;
+    }
+
+    void try_advance() {
+        std::uint64_t e = epoch.load();
+        for (record* r = records.load(std::memory_order_acquire); r;
+             r = r->next) {
+            std::uint64_t a = r->announced.load();
+            if ((a & 1) && (a >> 1) != e)
+                return;
+        }
+        epoch.compare_exchange_strong(e, e + 1);
+    }
+
+    epoch_domain() = default;
+
+   public:
+    epoch_domain(const epoch_domain&) = delete;
+    epoch_domain& operator=(const epoch_domain&) = delete;
+
+    ~epoch_domain() {
+        for (record* r = records.load(); r;) {
+            record* next = r->next;
+            for (std::vector<retired>& bag : r->bags)
+                free_bag(bag);
+            delete r;
+            r = next;
+        }
+    }
+
+    /**
+     * @brief Returns the domain of the program.
+     */
+    static epoch_domain& instance() {
+        static epoch_domain domain;
+        return domain;
+    }
+
+    /**
+     * @brief Enter a critical section (may be nested).
+     */
+    void enter() {
+        record& r = local();
+        if (r.depth++)
+            return;
+        // the epoch may move on between the load and the announcement; retry
+        // until it is still the announced one, which then can't pass e + 1
+        // before exit(), and so is a safe tag for what this thread retires
+        std::uint64_t e = epoch.load();
+        for (;;) {
+            r.announced.store(e << 1 | 1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::uint64_t now = epoch.load();
+            if (now == e)
+                break;
+            e = now;
+        }
+        // bag[t % 3] holds what was retired in epoch t - 3 or before
+        for (std::uint64_t t = r.seen + 1 > e - 2 ? r.seen + 1 : e - 2; t <= e;
+             ++t)
+            free_bag(r.bags[t % 3]);
+        r.seen = e;
+    }
+
+    /**
+     * @brief Leave a critical section.
+     */
+    void exit() {
+        record& r = local();
+        if (!--r.depth)
+            r.announced.store(0, std::memory_order_release);
+    }
+
+    /**
+     * @brief Hand over @c p, already unreachable from the shared structure,
+     * to be freed with @c deleter once no thread can hold it. Must be called
+     * within a critical section.
+     */
+    void retire(void* p, void (*deleter)(void*)) {
+        record& r = local();
+        r.bags[r.seen % 3].push_back(retired{p, deleter});
+        if (++r.retired_since_advance >= ADVANCE_PERIOD) {
+            r.retired_since_advance = 0;
+            try_advance();
+        }
+    }
+
+    /**
+     * @brief RAII critical section.
+     */
+    class guard {
+       private:
+        epoch_domain& domain;
+
+       public:
+        explicit guard(epoch_domain& domain_ = instance()) : domain(domain_) {
+            domain.enter();
+        }
+        ~guard() { domain.exit(); }
+
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+    };
+};
+
+/**
+ * @brief Background implementation for concurrent_skip_list.
+ *
+ * @note The lock-free skip list of Herlihy, Lev, Luchangco and Shavit (also
+ * Fraser, 2004): one node per element with a tower of @c height links. The
+ * lowest bit of a link marks its node as being removed. A node is in the set
+ * iff it is linked and unmarked on level 0; upper levels only speed searches
+ * up, and are linked bottom-up after level 0.
+ *
+ * @note A removal marks the tower top-down, level 0 last (whoever marks that
+ * one removes the element), then searches for the key, which unlinks marked
+ * nodes on the way. An insertion still linking the upper levels of a node
+ * that gets marked stops and searches too. Each of the two holds a
+ * reference, and whichever drops the last one retires the node.
+ */
+template <typename _Tp, std::size_t _Levels>
+class concurrent_skip_list_base {
+   protected:
+    static_assert(_Levels >= 1 && _Levels <= 64, "between 1 and 64 levels");
+
+    using link = std::atomic<std::uintptr_t>;
+
+    struct alignas(link) node {
+        _Tp key;
+        std::uint32_t height;
+        std::atomic<std::uint32_t> refs;  // by its inserter and its remover
+
+        link* links() noexcept { return reinterpret_cast<link*>(this + 1); }
+    };
+
+    static constexpr std::uintptr_t MARK = 1;
+
+    static node* pointer(std::uintptr_t l) noexcept {
+        return reinterpret_cast<node*>(l & ~MARK);
+    }
+
+    static bool marked(std::uintptr_t l) noexcept { return l & MARK; }
+
+    static std::uintptr_t to_link(node* n) noexcept {
+        return reinterpret_cast<std::uintptr_t>(n);
+    }
+
+    node* head;  // sentinel of height _Levels, whose key is never read
+    std::atomic<std::size_t> total;
+
+    /**
+     * @brief Returns a height with @a P(h) = 2^-h, from a per-thread
+     * xorshift generator.
+     */
+    static std::uint32_t random_height() noexcept {
+        thread_local std::uint64_t state =
+            0x9E3779B97F4A7C15ull ^
+            reinterpret_cast<std::uintptr_t>(&state);  // differ per thread
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return 1 + std::countr_zero(state | (1ull << (_Levels - 1)));
+    }
+
+    static node* create(const _Tp& key, std::uint32_t height) {
+        void* memory = ::operator new(sizeof(node) + height * sizeof(link));
+        node* n = new (memory) node{key, height, {2}};
+        for (std::uint32_t i = 0; i < height; ++i)
+            new (n->links() + i) link(0);
+        return n;
+    }
+
+    static void destroy(void* p) noexcept {
+        node* n = static_cast<node*>(p);
+        for (std::uint32_t i = 0; i < n->height; ++i)
+            n->links()[i].~link();
+        n->~node();
+        ::operator delete(p);
+    }
+
+    /**
+     * @brief Drop one reference to @c n, retiring it with the last one.
+     */
+    static void release(node* n) {
+        if (n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            epoch_domain::instance().retire(n, destroy);
+    }
+
+    /**
+     * @brief Fill @c preds and @c succs with the nodes around @c key on
+     * every level, unlinking marked nodes on the way.
+     *
+     * @return True if @c key is in the set, i.e. @c succs[0] holds it.
+     */
+    bool find(const _Tp& key, node** preds, node** succs) {
+    retry:
+        node* pred = head;
+        for (std::size_t i = _Levels; i-- > 0;) {
+            node* curr = pointer(pred->links()[i].load());
+            while (curr) {
+                std::uintptr_t succ = curr->links()[i].load();
+                if (marked(succ)) {
+                    std::uintptr_t expected = to_link(curr);
+                    if (!pred->links()[i].compare_exchange_strong(
+                            expected, succ & ~MARK))
+                        goto retry;
+                    curr = pointer(succ);
+                } else if (curr->key < key) {
+                    pred = curr;
+                    curr = pointer(succ);
+                } else {
+                    break;
+                }
+            }
+            preds[i] = pred;
+            succs[i] = curr;
+        }
+        return succs[0] && succs[0]->key == key;
+    }
+
+    /**
+     * @brief Returns the first unmarked node whose key is not less than
+     * @c key (with @a _Upper, greater than it), or null, without writing
+     * anything.
+     */
+    template <bool _Upper>
+    node* search(const _Tp& key) const {
+        node* pred = head;
+        node* curr = nullptr;
+        for (std::size_t i = _Levels; i-- > 0;) {
+            curr = pointer(pred->links()[i].load(std::memory_order_acquire));
+            while (curr) {
+                std::uintptr_t succ =
+                    curr->links()[i].load(std::memory_order_acquire);
+                if (marked(succ))
+                    curr = pointer(succ);
+                else if (_Upper ? !(key < curr->key) : curr->key < key)
+                    pred = curr, curr = pointer(succ);
+                else
+                    break;
+            }
+        }
+        return curr;
+    }
+
+    concurrent_skip_list_base() : head(create(_Tp(), _Levels)), total(0) {}
+
+    concurrent_skip_list_base(const concurrent_skip_list_base&) = delete;
+    concurrent_skip_list_base& operator=(const concurrent_skip_list_base&) =
+        delete;
+
+    ~concurrent_skip_list_base() {
+        reset();
+        destroy(head);
+    }
+
+    bool insert(const _Tp& key) {
+        epoch_domain::guard guard;
+        node* preds[_Levels];
+        node* succs[_Levels];
+        node* n = nullptr;
+        for (;;) {
+            if (find(key, preds, succs)) {
+                if (n)
+                    destroy(n);  // never published
+                return false;
+            }
+            if (!n)
+                n = create(key, random_height());
+            for (std::uint32_t i = 0; i < n->height; ++i)
+                n->links()[i].store(to_link(succs[i]),
+                                    std::memory_order_relaxed);
+            std::uintptr_t expected = to_link(succs[0]);
+            if (preds[0]->links()[0].compare_exchange_strong(expected,
+                                                             to_link(n)))
+                break;
+        }
+        total.fetch_add(1, std::memory_order_relaxed);
+        for (std::uint32_t i = 1; i < n->height; ++i) {
+            for (;;) {
+                // point the new link at succs[i], unless n is being removed
+                std::uintptr_t next = n->links()[i].load();
+                if (marked(next))
+                    goto linked;
+                if (pointer(next) != succs[i] &&
+                    !n->links()[i].compare_exchange_strong(next,
+                                                           to_link(succs[i])))
+                    goto linked;
+                std::uintptr_t expected = to_link(succs[i]);
+                if (preds[i]->links()[i].compare_exchange_strong(expected,
+                                                                 to_link(n)))
+                    break;
+                find(key, preds, succs);
+            }
+        }
+    linked:
+        if (marked(n->links()[0].load()))  // removed meanwhile: help unlink
+            find(key, preds, succs);
+        release(n);
+        return true;
+    }
+
+    bool erase(const _Tp& key) {
+        epoch_domain::guard guard;
+        node* preds[_Levels];
+        node* succs[_Levels];
+        if (!find(key, preds, succs))
+            return false;
+        node* victim = succs[0];
+        for (std::uint32_t i = victim->height; i-- > 1;) {
+            std::uintptr_t next = victim->links()[i].load();
+            while (!marked(next) &&
+                   !victim->links()[i].compare_exchange_weak(next, next | MARK))
+                ;
+        }
+        std::uintptr_t next = victim->links()[0].load();
+        do {
+            if (marked(next))
+                return false;  // another thread removed it first
+        } while (!victim->links()[0].compare_exchange_weak(next, next | MARK));
+        total.fetch_sub(1, std::memory_order_relaxed);
+        find(key, preds, succs);
+        release(victim);
+        return true;
+    }
+
+    /**
+     * @brief Free every node. Must not run concurrently with anything.
+     */
+    void reset() noexcept {
+        for (node* n = pointer(head->links()[0].load()); n;) {
+            node* next = pointer(n->links()[0].load());
+            destroy(n);
+            n = next;
+        }
+        for (std::size_t i = 0; i < _Levels; ++i)
+            head->links()[i].store(0);
+        total.store(0);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_CONCURRENT_SKIP_LIST_BASE */
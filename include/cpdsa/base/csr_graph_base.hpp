@@ -0,0 +1,115 @@
+/**
+ * CPDSA: Compressed sparse row graph, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/csr_graph_base.hpp
+ */
+
+#ifndef CPDSA_CSR_GRAPH_BASE
+#define CPDSA_CSR_GRAPH_BASE
+
+#include <cstddef>
+#include <cstdint>      // for std::uint32_t
+#include <numeric>      // for std::partial_sum
+#include <type_traits>  // for std::conditional_t, std::is_void_v
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for csr_graph.
+ *
+ * @note The arcs leaving vertex @a v are @a targets[offsets[v]] to
+ * @a targets[offsets[v + 1] - 1], with their weights at the same positions of
+ * @a arc_weights: a traversal reads each adjacency list as one contiguous run,
+ * and the whole graph takes three allocations instead of one per vertex.
+ *
+ * @note Building is a counting sort of the arcs by their source, like
+ * @c __do_bucket_sort with one bucket per vertex: count the degrees, turn
+ * them into offsets with a prefix sum, then place the arcs backwards. Arcs
+ * keep their input order within each list.
+ */
+template <typename _Weight>
+class csr_graph_base {
+   protected:
+    using vertex_type = std::uint32_t;
+
+    static constexpr bool WEIGHTED = !std::is_void_v<_Weight>;
+
+    struct no_weight {};
+
+    using weight_type = std::conditional_t<WEIGHTED, _Weight, no_weight>;
+
+    /**
+     * @brief An arc from @c from to @c to, with its weight for weighted
+     * graphs.
+     */
+    struct edge {
+        vertex_type from;
+        vertex_type to;
+        [[no_unique_address]] weight_type weight{};
+    };
+
+    std::vector<std::size_t> offsets{0};
+    std::vector<vertex_type> targets;
+    std::vector<weight_type> arc_weights;
+
+    /**
+     * @brief Replace the graph with @c n vertices and @c edges, each also
+     * added backwards if @c undirected is set. Takes @a O(n + m).
+     */
+    void build(std::size_t n, const std::vector<edge>& edges,
+               bool undirected) {
+        const std::size_t m = edges.size() * (undirected ? 2 : 1);
+        offsets.assign(n + 1, 0);
+        for (const edge& e : edges) {
+            ++offsets[e.from];
+            if (undirected)
+                ++offsets[e.to];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        targets.resize(m);
+        if constexpr (WEIGHTED)
+            arc_weights.resize(m);
+        // as in __do_bucket_sort, each arc goes to the end of what is left
+        // of its list
+        for (std::size_t i = edges.size(); i--;) {
+            const edge& e = edges[i];
+            if (undirected)
+                place(e.to, e.from, e.weight);
+            place(e.from, e.to, e.weight);
+        }
+    }
+
+    /**
+     * @brief Replace the graph with @c other with every arc reversed, by the
+     * same counting sort. Takes @a O(n + m).
+     */
+    void build_transpose(const csr_graph_base& other) {
+        const std::size_t n = other.offsets.size() - 1;
+        offsets.assign(n + 1, 0);
+        for (vertex_type v : other.targets)
+            ++offsets[v];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        targets.resize(other.targets.size());
+        if constexpr (WEIGHTED)
+            arc_weights.resize(other.targets.size());
+        for (std::size_t v = n; v--;)
+            for (std::size_t i = other.offsets[v + 1]; i-- > other.offsets[v];) {
+                if constexpr (WEIGHTED)
+                    place(other.targets[i], v, other.arc_weights[i]);
+                else
+                    place(other.targets[i], v, no_weight{});
+            }
+    }
+
+    void place(vertex_type from, vertex_type to, const weight_type& w) {
+        const std::size_t at = --offsets[from];
+        targets[at] = to;
+        if constexpr (WEIGHTED)
+            arc_weights[at] = w;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_CSR_GRAPH_BASE */
@@ -0,0 +1,142 @@
+/**
+ * CPDSA: 64-ary bitset tree, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/fast_set_base.hpp
+ */
+
+#ifndef CPDSA_FAST_SET_BASE
+#define CPDSA_FAST_SET_BASE
+
+#include <array>
+#include <bit>      // for std::countr_zero, std::countl_zero
+#include <cstdint>  // for std::uint64_t
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for fast_set.
+ *
+ * @note Level 0 holds one bit per value; bit @a i of level @a h + 1 is set
+ * iff word @a i of level @a h is non-zero. The top level is a single word, so
+ * there are @a ceil(log_64(U)) levels.
+ */
+template <size_t U>
+class fast_set_base {
+   private:
+    using word_type = std::uint64_t;
+
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t WORD_SHIFT = 6;
+
+    /**
+     * @brief Returns the number of levels needed for @a U values.
+     */
+    static constexpr size_t count_levels() noexcept {
+        size_t result = 1;
+        for (size_t n = U; n > WORD_BITS; n = (n + WORD_BITS - 1) >> WORD_SHIFT)
+            ++result;
+        return result;
+    }
+
+   protected:
+    static constexpr size_t LEVELS = count_levels();
+
+    std::array<std::vector<word_type>, LEVELS> levels;
+
+    fast_set_base() {
+        size_t n = U;
+        for (auto& level : levels) {
+            n = (n + WORD_BITS - 1) >> WORD_SHIFT;
+            level.assign(n, 0);
+        }
+    }
+
+    /**
+     * @brief Returns whether @c x (less than @a U) is in the set.
+     */
+    [[nodiscard]] bool test(size_t x) const noexcept {
+        return levels[0][x >> WORD_SHIFT] >> (x & (WORD_BITS - 1)) & 1;
+    }
+
+    /**
+     * @brief Set the bit of @c x (less than @a U), and those above it that
+     * were not set yet.
+     */
+    void set(size_t x) noexcept {
+        for (auto& level : levels) {
+            word_type& word = level[x >> WORD_SHIFT];
+            const bool was_empty = !word;
+            word |= word_type(1) << (x & (WORD_BITS - 1));
+            if (!was_empty)
+                return;
+            x >>= WORD_SHIFT;
+        }
+    }
+
+    /**
+     * @brief Clear the bit of @c x (less than @a U), and those above it whose
+     * word became empty.
+     */
+    void reset(size_t x) noexcept {
+        for (auto& level : levels) {
+            word_type& word = level[x >> WORD_SHIFT];
+            word &= ~(word_type(1) << (x & (WORD_BITS - 1)));
+            if (word)
+                return;
+            x >>= WORD_SHIFT;
+        }
+    }
+
+    /**
+     * @brief Returns the smallest value in the set not less than @c x, or
+     * @a U if no such value exists.
+     *
+     * @note Climbs until a word holds a set bit at or after the current
+     * position, then descends to the lowest set bit of each word below.
+     */
+    [[nodiscard]] size_t next(size_t x) const noexcept {
+        for (size_t h = 0; h < LEVELS; ++h) {
+            if ((x >> WORD_SHIFT) >= levels[h].size())
+                return U;
+            const word_type word = levels[h][x >> WORD_SHIFT] &
+                                   (~word_type(0) << (x & (WORD_BITS - 1)));
+            if (word) {
+                x = (x & ~(WORD_BITS - 1)) | std::countr_zero(word);
+                while (h--)
+                    x = (x << WORD_SHIFT) | std::countr_zero(levels[h][x]);
+                return x;
+            }
+            x = (x >> WORD_SHIFT) + 1;
+        }
+        return U;
+    }
+
+    /**
+     * @brief Returns the largest value in the set not more than @c x (less
+     * than @a U), or @a U if no such value exists.
+     */
+    [[nodiscard]] size_t prev(size_t x) const noexcept {
+        for (size_t h = 0; h < LEVELS; ++h) {
+            const word_type word =
+                levels[h][x >> WORD_SHIFT] &
+                (~word_type(0) >> (WORD_BITS - 1 - (x & (WORD_BITS - 1))));
+            if (word) {
+                x = (x & ~(WORD_BITS - 1)) |
+                    (WORD_BITS - 1 - std::countl_zero(word));
+                while (h--)
+                    x = (x << WORD_SHIFT) |
+                        (WORD_BITS - 1 - std::countl_zero(levels[h][x]));
+                return x;
+            }
+            if ((x >> WORD_SHIFT) == 0)
+                return U;
+            x = (x >> WORD_SHIFT) - 1;
+        }
+        return U;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_FAST_SET_BASE */
@@ -0,0 +1,205 @@
+/**
+ * CPDSA: Ordered set over a small universe, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/flat_ordered_set_base.hpp
+ */
+
+#ifndef CPDSA_FLAT_ORDERED_SET_BASE
+#define CPDSA_FLAT_ORDERED_SET_BASE
+
+#include <bit>       // for std::bit_floor
+#include <concepts>  // for std::integral
+#include <type_traits>
+#include <vector>
+
+#include "ordered_set_base.hpp"  // for ordered_set_sum_type
+
+/**
+ * @brief Largest `RB - LB` for which @c ordered_set switches to the flat
+ * backend. Define it before including CPDSA to trade memory for speed.
+ */
+#ifndef CPDSA_ORDERED_SET_FLAT_LIMIT
+#define CPDSA_ORDERED_SET_FLAT_LIMIT (1 << 20)
+#endif
+
+namespace cpdsa {
+
+/**
+ * @brief Bounds small enough for @c ordered_set to keep one counter per value.
+ */
+template <typename _Tp, _Tp LB, _Tp RB>
+concept Flat_ordered_set_range =
+    std::integral<_Tp> && LB < RB &&
+    static_cast<std::make_unsigned_t<_Tp>>(
+        static_cast<std::make_unsigned_t<_Tp>>(RB) -
+        static_cast<std::make_unsigned_t<_Tp>>(LB)) <=
+        static_cast<unsigned long long>(CPDSA_ORDERED_SET_FLAT_LIMIT);
+
+/**
+ * @brief Background implementation for ordered_set over a small universe.
+ *
+ * @note A Fenwick tree with one slot per value in `[LB, RB)`: no pointers, no
+ * allocation after construction, and a descent touches one slot per level.
+ * Slot @a i (1-based) stands for the value @a LB + @a i - 1.
+ */
+template <std::integral _Tp, _Tp LB, _Tp RB>
+class flat_ordered_set_base {
+   private:
+    using unsigned_type = std::make_unsigned_t<_Tp>;
+
+   protected:
+    using sum_type = ordered_set_sum_type<_Tp>;
+
+    static constexpr size_t SIZE = static_cast<unsigned_type>(
+        static_cast<unsigned_type>(RB) - static_cast<unsigned_type>(LB));
+
+    std::vector<int> tree;       // tree[0] is unused
+    std::vector<sum_type> sums;  // same layout, holding sums of values
+    size_t total;
+
+    flat_ordered_set_base() : tree(SIZE + 1), sums(SIZE + 1), total(0) {}
+
+    /**
+     * @brief Returns the slot of a value in `[LB, RB)`.
+     */
+    [[nodiscard]] static constexpr size_t slot(const _Tp& val) noexcept {
+        return static_cast<unsigned_type>(static_cast<unsigned_type>(val) -
+                                          static_cast<unsigned_type>(LB)) +
+               1;
+    }
+
+    /**
+     * @brief Returns the value standing for a slot.
+     */
+    [[nodiscard]] static constexpr _Tp value(size_t i) noexcept {
+        return static_cast<_Tp>(static_cast<unsigned_type>(LB) +
+                                static_cast<unsigned_type>(i - 1));
+    }
+
+    /**
+     * @brief Returns the slot of the largest value not more than @c val, or 0
+     * if @c val < @a LB.
+     */
+    [[nodiscard]] static constexpr size_t slot_at_most(const _Tp& val) noexcept {
+        if (val < LB)
+            return 0;
+        if (val >= RB)
+            return SIZE;
+        return slot(val);
+    }
+
+    /**
+     * @brief Add @c delta elements to slot @c i.
+     */
+    void add(size_t i, int delta) noexcept {
+        total += delta;
+        const sum_type delta_sum = static_cast<sum_type>(delta) * value(i);
+        for (; i <= SIZE; i += i & -i) {
+            tree[i] += delta;
+            sums[i] += delta_sum;
+        }
+    }
+
+    /**
+     * @brief Turn the Fenwick arrays into plain per-slot arrays, in @a O(X).
+     */
+    void unroll() noexcept {
+        for (size_t i = SIZE; i; --i) {
+            size_t parent = i + (i & -i);
+            if (parent <= SIZE) {
+                tree[parent] -= tree[i];
+                sums[parent] -= sums[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Turn plain per-slot arrays back into Fenwick arrays, in @a O(X).
+     */
+    void roll() noexcept {
+        total = 0;
+        for (size_t i = 1; i <= SIZE; ++i)
+            total += tree[i];
+        for (size_t i = 1; i <= SIZE; ++i) {
+            size_t parent = i + (i & -i);
+            if (parent <= SIZE) {
+                tree[parent] += tree[i];
+                sums[parent] += sums[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the number of elements in slots `[1, i]`.
+     */
+    [[nodiscard]] int prefix(size_t i) const noexcept {
+        int result = 0;
+        for (; i; i -= i & -i)
+            result += tree[i];
+        return result;
+    }
+
+    /**
+     * @brief Returns the sum of the elements in slots `[1, i]`.
+     */
+    [[nodiscard]] sum_type prefix_sum(size_t i) const noexcept {
+        sum_type result = 0;
+        for (; i; i -= i & -i)
+            result += sums[i];
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of elements in slot @c i.
+     */
+    [[nodiscard]] int point(size_t i) const noexcept {
+        int result = tree[i];
+        // walk down from i - 1 until reaching the range tree[i] starts at
+        for (size_t stop = i - (i & -i), j = i - 1; j > stop; j -= j & -j)
+            result -= tree[j];
+        return result;
+    }
+
+    /**
+     * @brief Returns the smallest slot @a i such that slots `[1, i]` hold at
+     * least @c k elements, by binary lifting.
+     *
+     * @note @c k must be in `[1, total]`.
+     */
+    [[nodiscard]] size_t lift(size_t k) const noexcept {
+        size_t pos = 0;
+        for (size_t step = std::bit_floor(SIZE); step; step >>= 1) {
+            if (pos + step <= SIZE &&
+                static_cast<size_t>(tree[pos + step]) < k) {
+                pos += step;
+                k -= tree[pos];
+            }
+        }
+        return pos + 1;
+    }
+
+    /**
+     * @brief Returns the sum of the @c k smallest elements, with the same
+     * descent as @c lift.
+     *
+     * @note @c k must be in `[0, total]`.
+     */
+    [[nodiscard]] sum_type lift_sum(size_t k) const noexcept {
+        size_t pos = 0;
+        sum_type result = 0;
+        for (size_t step = std::bit_floor(SIZE); step; step >>= 1) {
+            if (pos + step <= SIZE &&
+                static_cast<size_t>(tree[pos + step]) < k) {
+                pos += step;
+                k -= tree[pos];
+                result += sums[pos];
+            }
+        }
+        // the rest are copies of the value in the next slot
+        return k ? result + static_cast<sum_type>(k) * value(pos + 1) : result;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_FLAT_ORDERED_SET_BASE */
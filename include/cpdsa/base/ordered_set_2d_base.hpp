@@ -0,0 +1,161 @@
+/**
+ * CPDSA: Two-dimensional ordered set, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/ordered_set_2d_base.hpp
+ */
+
+#ifndef CPDSA_ORDERED_SET_2D_BASE
+#define CPDSA_ORDERED_SET_2D_BASE
+
+#include <concepts>  // for std::integral
+#include <memory>    // for std::unique_ptr
+#include <numeric>   // for std::midpoint
+
+#include "../bucketed_ordered_set.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for ordered_set_2d.
+ *
+ * @note A dynamic segment tree on x, like @c ordered_set_base, where each node
+ * owns the y coordinates of the points whose x falls in its range. Those are
+ * kept in a @c bucketed_ordered_set, so that a node holding @a k points costs
+ * @a O(k / B * log(X)) inner nodes rather than @a O(k log(X)).
+ */
+template <std::integral _Tp, _Tp LB, _Tp RB>
+class ordered_set_2d_base {
+   private:
+    using inner_type = bucketed_ordered_set<_Tp, LB, RB>;
+
+    /**
+     * @brief Node implementation.
+     */
+    struct node {
+        inner_type ys;  // y coordinates of the points in the node
+        std::unique_ptr<node> left_child;
+        std::unique_ptr<node> right_child;  // left and right child
+    };
+
+   protected:
+    // these should have been a simple enum but
+    // are also used by child classes so ...
+    enum NODE_UPDATE_ACTIONS { ADD_ONCE, REMOVE_ONCE };
+
+    node root;
+
+    /**
+     * @brief Drop every node.
+     */
+    void reset() { root = node(); }
+
+    /**
+     * @brief Add or remove the point `(x, y)` in a node and all its
+     * descendants containing @c x.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's x range.
+     * @param r Right boundary of the node's x range.
+     * @param x,y The point being updated.
+     * @param action Action specified (see @c NODE_UPDATE_ACTIONS)
+     *
+     * @note Removals must only be issued for points that exist, otherwise the
+     * ancestors would lose a y belonging to some other point.
+     */
+    void update(node& id,
+                const _Tp& l,
+                const _Tp& r,
+                const _Tp& x,
+                const _Tp& y,
+                int action) {
+        if (action == NODE_UPDATE_ACTIONS::ADD_ONCE)
+            id.ys.insert(y);
+        else
+            id.ys.erase_once(y);
+        if (l == r)
+            return;
+
+        _Tp mid = std::midpoint(l, r);
+        std::unique_ptr<node>& child = x <= mid ? id.left_child : id.right_child;
+        if (child == nullptr)
+            child = std::make_unique<node>();
+        if (x <= mid)
+            update(*child, l, mid, x, y, action);
+        else
+            update(*child, mid + 1, r, x, y, action);
+        if (child->ys.empty())
+            child.reset();
+    }
+
+    /**
+     * @brief Returns the number of points of a node in `[x1,x2] x [y1,y2]`.
+     */
+    [[nodiscard]] int get(const node& id,
+                          const _Tp& l,
+                          const _Tp& r,
+                          const _Tp& x1,
+                          const _Tp& x2,
+                          const _Tp& y1,
+                          const _Tp& y2) const {
+        if (id.ys.empty() || r < x1 || x2 < l)
+            return 0;
+        if (x1 <= l && r <= x2)
+            return id.ys.count(y1, y2);
+
+        _Tp mid = std::midpoint(l, r);
+        int result = 0;
+        if (id.left_child != nullptr)
+            result += get(*(id.left_child), l, mid, x1, x2, y1, y2);
+        if (id.right_child != nullptr)
+            result += get(*(id.right_child), mid + 1, r, x1, x2, y1, y2);
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of copies of the point `(x, y)`, by walking
+     * down to the node of @c x.
+     */
+    [[nodiscard]] int multiplicity(const _Tp& x, const _Tp& y) const {
+        const node* cur = &root;
+        _Tp l = LB, r = RB;
+        while (l != r) {
+            _Tp mid = std::midpoint(l, r);
+            if (x <= mid) {
+                cur = cur->left_child.get();
+                r = mid;
+            } else {
+                cur = cur->right_child.get();
+                l = mid + 1;
+            }
+            if (cur == nullptr)
+                return 0;
+        }
+        return cur->ys.count(y, y);
+    }
+
+    /**
+     * @brief Returns the number of outer nodes and the bytes held by their
+     * inner sets.
+     */
+    [[nodiscard]] static size_t count_nodes(const node& id,
+                                            size_t& bytes) noexcept {
+        size_t result = 1;
+        bytes += id.ys.memory_usage();
+        if (id.left_child != nullptr)
+            result += count_nodes(*(id.left_child), bytes);
+        if (id.right_child != nullptr)
+            result += count_nodes(*(id.right_child), bytes);
+        return result;
+    }
+
+    /**
+     * @brief Returns the size in bytes of one outer node, inner set excluded.
+     */
+    [[nodiscard]] static constexpr size_t node_size() noexcept {
+        return sizeof(node) - sizeof(inner_type);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_ORDERED_SET_2D_BASE */
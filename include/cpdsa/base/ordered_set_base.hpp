@@ -7,11 +7,32 @@
 #ifndef CPDSA_ORDERED_SET_BASE
 #define CPDSA_ORDERED_SET_BASE
 
-#include <memory>   // for std::unique_ptr
-#include <numeric>  // for std::midpoint
+#include <algorithm>  // for std::upper_bound, std::fill
+#include <concepts>   // for std::integral
+#include <cstdint>    // for std::uint32_t
+#include <memory>     // for std::unique_ptr
+#include <numeric>    // for std::midpoint
+#include <type_traits>
+#include <vector>
 
 namespace cpdsa {
 
+/**
+ * @brief Accumulator wide enough to add up many values of type @c _Tp without
+ * overflowing: 64 bits for types narrower than that, 128 bits (where the
+ * compiler has them) otherwise.
+ */
+template <std::integral _Tp>
+using ordered_set_sum_type = std::conditional_t<
+    (sizeof(_Tp) < sizeof(long long)),
+    std::conditional_t<std::is_signed_v<_Tp>, long long, unsigned long long>,
+#ifdef __SIZEOF_INT128__
+    std::conditional_t<std::is_signed_v<_Tp>, __int128, unsigned __int128>
+#else
+    std::conditional_t<std::is_signed_v<_Tp>, long long, unsigned long long>
+#endif
+    >;
+
 /**
  * @brief Background implementation for ordered_set.
  *
@@ -23,22 +44,24 @@ class ordered_set_base {
    private:
     static const int NULL_NODE_COUNT = 0;
     static const int NULL_NODE_SUM = 0;
-    static const int NULL_NODE_MIN = RB;
-    static const int NULL_NODE_MAX = LB;
+    static constexpr _Tp NULL_NODE_MIN = RB;
+    static constexpr _Tp NULL_NODE_MAX = LB;
 
     static const int EMPTY_NODE_COUNT = 0;
     static const int EMPTY_NODE_SUM = 0;
-    static const int EMPTY_NODE_MIN = RB;
-    static const int EMPTY_NODE_MAX = LB;
+    static constexpr _Tp EMPTY_NODE_MIN = RB;
+    static constexpr _Tp EMPTY_NODE_MAX = LB;
 
     std::nullptr_t NULL_NODE;
 
+    using sum_type = ordered_set_sum_type<_Tp>;
+
     /**
      * @brief Node implementation.
      */
     struct node {
         int cnt;            // the amount of elements currently in the node ...
-        _Tp sum;            // ... and their sum.
+        sum_type sum;       // ... and their sum.
         _Tp lowest_value;   // Value bounds for the node.
         _Tp highest_value;  // An uninstantiated or null node has
                             // lowest_value = RB and highest_value = LB as
@@ -67,7 +90,7 @@ class ordered_set_base {
          * `[u,v]`
          */
         bool contained_by(_Tp u, _Tp v) const noexcept {
-            return (u <= lowest_value && lowest_value <= v);
+            return (u <= lowest_value && highest_value <= v);
         }
     };
 
@@ -81,6 +104,11 @@ class ordered_set_base {
 
     ordered_set_base() : root() {}
 
+    /**
+     * @brief Drop every node and reset the root to an empty node.
+     */
+    void reset() { root = node(); }
+
     /**
      * @brief Creates a new node and attaches it to the parent node `id` in
      * the given direction.
@@ -107,7 +135,7 @@ class ordered_set_base {
     /**
      * @brief Wrapper function for sum.
      */
-    [[nodiscard]] constexpr _Tp get_sum(
+    [[nodiscard]] constexpr sum_type get_sum(
         const std::unique_ptr<node>& id) const noexcept {
         return id == NULL_NODE ? NULL_NODE_SUM : id->sum;
     }
@@ -150,7 +178,8 @@ class ordered_set_base {
                 leaf.sum -= val;
                 break;
             case NODE_UPDATE_ACTIONS::REMOVE_ALL:
-                leaf.cnt = leaf.sum = 0;
+                leaf.cnt = 0;
+                leaf.sum = 0;
                 break;
             default:
                 break;
@@ -188,6 +217,11 @@ class ordered_set_base {
      * its values modifies first, followed by its ancestor nodes through
      * `update_from_childs`.
      *
+     * @note Removals never create nodes, and a child left empty by an update is
+     * freed on the way back up. Every node but the root therefore holds at
+     * least one element, so memory follows the current size of the container
+     * rather than its history.
+     *
      */
     void update(node& id,
                 const _Tp& l,
@@ -199,22 +233,193 @@ class ordered_set_base {
             return;
         }
 
+        const bool removing = action != NODE_UPDATE_ACTIONS::ADD_ONCE;
         _Tp mid = std::midpoint(l, r);
         if (val <= mid) {
-            if (id.left_child == NULL_NODE)
+            if (id.left_child == NULL_NODE) {
+                if (removing)
+                    return;
                 create_node(id, NODE_DIRECTIONS::LEFT);
+            }
             update(*(id.left_child), l, mid, val, action);
+            if (id.left_child->cnt == 0)
+                id.left_child.reset();
         } else {
-            if (id.right_child == NULL_NODE)
+            if (id.right_child == NULL_NODE) {
+                if (removing)
+                    return;
                 create_node(id, NODE_DIRECTIONS::RIGHT);
+            }
             update(*(id.right_child), mid + 1, r, val, action);
+            if (id.right_child->cnt == 0)
+                id.right_child.reset();
+        }
+
+        update_from_childs(id);
+    }
+
+    /**
+     * @brief Merge node @c other into node @c id, both covering `[l,r]`.
+     *
+     * @param id The current node, receiving the elements.
+     * @param other The matching node of the other tree, left empty afterwards.
+     * @param l Left boundary of the nodes' range.
+     * @param r Right boundary of the nodes' range.
+     *
+     * @note A subtree present on only one side is relinked as is, and every
+     * step that goes deeper frees a node of @c other. A sequence of merges
+     * thus costs @a O(n log(X)) in total for @a n inserted elements.
+     */
+    void merge_nodes(node& id, node& other, const _Tp& l, const _Tp& r) {
+        if (l == r) {
+            id.cnt += other.cnt;
+            id.sum += other.sum;
+            id.lowest_value = (id.cnt ? l : EMPTY_NODE_MIN);
+            id.highest_value = (id.cnt ? l : EMPTY_NODE_MAX);
+            return;
+        }
+
+        _Tp mid = std::midpoint(l, r);
+        merge_child(id.left_child, other.left_child, l, mid);
+        merge_child(id.right_child, other.right_child, mid + 1, r);
+        update_from_childs(id);
+    }
+
+    /**
+     * @brief Merge the child @c theirs into the child @c mine (see
+     * @c merge_nodes).
+     */
+    void merge_child(std::unique_ptr<node>& mine,
+                     std::unique_ptr<node>& theirs,
+                     const _Tp& l,
+                     const _Tp& r) {
+        if (theirs == NULL_NODE)
+            return;
+        if (mine == NULL_NODE) {
+            mine = std::move(theirs);
+            return;
+        }
+        merge_nodes(*mine, *theirs, l, r);
+        theirs.reset();
+    }
+
+    /**
+     * @brief Move every element of node @c id greater than @c val into node
+     * @c out, both covering `[l,r]`.
+     *
+     * @param id The current node, keeping the elements not greater than
+     * @c val.
+     * @param out The matching (empty) node of the other tree.
+     * @param l Left boundary of the nodes' range.
+     * @param r Right boundary of the nodes' range.
+     * @param val The value to split at, within `[l,r]`.
+     *
+     * @note Only the path to @c val is visited: every subtree hanging right of
+     * it is relinked as is.
+     */
+    void split_nodes(node& id,
+                     node& out,
+                     const _Tp& l,
+                     const _Tp& r,
+                     const _Tp& val) {
+        if (l == r)
+            return;
+
+        _Tp mid = std::midpoint(l, r);
+        if (val <= mid) {
+            out.right_child = std::move(id.right_child);
+            if (id.left_child != NULL_NODE) {
+                create_node(out, NODE_DIRECTIONS::LEFT);
+                split_nodes(*(id.left_child), *(out.left_child), l, mid, val);
+                if (id.left_child->cnt == 0)
+                    id.left_child.reset();
+                if (out.left_child->cnt == 0)
+                    out.left_child.reset();
+            }
+        } else if (id.right_child != NULL_NODE) {
+            create_node(out, NODE_DIRECTIONS::RIGHT);
+            split_nodes(*(id.right_child), *(out.right_child), mid + 1, r,
+                        val);
+            if (id.right_child->cnt == 0)
+                id.right_child.reset();
+            if (out.right_child->cnt == 0)
+                out.right_child.reset();
         }
 
         update_from_childs(id);
+        update_from_childs(out);
     }
 
     /**
-     * @brief Returns the sum of values stored in the range of a given node.
+     * @brief Returns the number of nodes in the subtree of a node.
+     *
+     * @param id The current node.
+     */
+    [[nodiscard]] size_t count_nodes(const node& id) const noexcept {
+        size_t result = 1;
+        if (id.left_child != NULL_NODE)
+            result += count_nodes(*(id.left_child));
+        if (id.right_child != NULL_NODE)
+            result += count_nodes(*(id.right_child));
+        return result;
+    }
+
+    /**
+     * @brief Append a node and its subtree to @c out in preorder, children
+     * being referred to by their index in @c out (0 if missing).
+     *
+     * @param id The current node.
+     * @param out Receives the records (see @c ordered_set_snapshot_node).
+     */
+    template <typename _Record>
+    void flatten(const node& id, std::vector<_Record>& out) const {
+        const size_t self = out.size();
+        out.push_back(_Record{id.sum, id.cnt, 0, 0, id.lowest_value,
+                              id.highest_value});
+        if (id.left_child != NULL_NODE) {
+            out[self].left_child = static_cast<std::uint32_t>(out.size());
+            flatten(*(id.left_child), out);
+        }
+        if (id.right_child != NULL_NODE) {
+            out[self].right_child = static_cast<std::uint32_t>(out.size());
+            flatten(*(id.right_child), out);
+        }
+    }
+
+    /**
+     * @brief Rebuild a node and its subtree from the records written by
+     * @c flatten.
+     *
+     * @param id The node to fill in, without children.
+     * @param records The records.
+     * @param self The index of the record of @c id.
+     */
+    template <typename _Record>
+    void unflatten(node& id, const _Record* records, std::uint32_t self) {
+        const _Record& cur = records[self];
+        id.cnt = cur.cnt;
+        id.sum = cur.sum;
+        id.lowest_value = cur.lowest_value;
+        id.highest_value = cur.highest_value;
+        if (cur.left_child) {
+            id.left_child = std::make_unique<node>();
+            unflatten(*(id.left_child), records, cur.left_child);
+        }
+        if (cur.right_child) {
+            id.right_child = std::make_unique<node>();
+            unflatten(*(id.right_child), records, cur.right_child);
+        }
+    }
+
+    /**
+     * @brief Returns the size in bytes of one node.
+     */
+    [[nodiscard]] static constexpr size_t node_size() noexcept {
+        return sizeof(node);
+    }
+
+    /**
+     * @brief Returns the number of elements of a node in the range `[u,v]`.
      *
      * @param id The current node.
      * @param l Left boundary of the node's range.
@@ -222,7 +427,7 @@ class ordered_set_base {
      * @param u Left boundary of the query range.
      * @param v Right boundary of the query range.
      */
-    [[nodiscard]] constexpr _Tp get(node& id,
+    [[nodiscard]] constexpr _Tp get(const node& id,
                                     const _Tp& l,
                                     const _Tp& r,
                                     _Tp u,
@@ -241,6 +446,66 @@ class ordered_set_base {
         return result;
     }
 
+    /**
+     * @brief Returns the sum of the elements of a node in the range `[u,v]`.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param u Left boundary of the query range.
+     * @param v Right boundary of the query range.
+     */
+    [[nodiscard]] constexpr sum_type range_sum(const node& id,
+                                               const _Tp& l,
+                                               const _Tp& r,
+                                               _Tp u,
+                                               _Tp v) const {
+        if (id.out_of_bound(u, v))
+            return NULL_NODE_SUM;
+        if (id.contained_by(u, v))
+            return id.sum;
+
+        _Tp mid = std::midpoint(l, r);
+        sum_type result = 0;
+        if (id.left_child != NULL_NODE)
+            result += range_sum(*(id.left_child), l, mid, u, v);
+        if (id.right_child != NULL_NODE)
+            result += range_sum(*(id.right_child), mid + 1, r, u, v);
+        return result;
+    }
+
+    /**
+     * @brief Returns the sum of the k smallest elements of a node, in a single
+     * descent using the stored sums.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param k The number of elements to add up, at most @c id.cnt.
+     */
+    [[nodiscard]] constexpr sum_type smallest_sum(const node& id,
+                                                  _Tp l,
+                                                  _Tp r,
+                                                  size_t k) const {
+        sum_type result = 0;
+        const node* cur = &id;
+        while (k && l != r) {
+            _Tp mid = std::midpoint(l, r);
+            size_t left_cnt = get_cnt(cur->left_child);
+            if (left_cnt >= k) {
+                cur = cur->left_child.get();
+                r = mid;
+            } else {
+                result += get_sum(cur->left_child);
+                k -= left_cnt;
+                cur = cur->right_child.get();
+                l = mid + 1;
+            }
+        }
+        // a leaf holds copies of a single value
+        return result + static_cast<sum_type>(k) * l;
+    }
+
     /**
      * @brief Find the value of the k-th largest (1-based) element in the given
      * node
@@ -253,7 +518,7 @@ class ordered_set_base {
      * @return Either said value or RB when all traversed nodes are either empty
      * or null (i.e. no such value exists).
      */
-    [[nodiscard]] constexpr _Tp k_largest(node& id,
+    [[nodiscard]] constexpr _Tp k_largest(const node& id,
                                           const _Tp& l,
                                           const _Tp& r,
                                           size_t k) const {
@@ -262,7 +527,7 @@ class ordered_set_base {
 
         _Tp mid = std::midpoint(l, r);
 
-        if (get_cnt(id.left_child) >= k)
+        if (static_cast<size_t>(get_cnt(id.left_child)) >= k)
             return k_largest(*(id.left_child), l, mid, k);
         else if (id.right_child != NULL_NODE)
             return k_largest(*(id.right_child), mid + 1, r,
@@ -282,7 +547,7 @@ class ordered_set_base {
      * @return Either said value or RB when all traversed nodes are either empty
      * or null (i.e. no such value exists).
      */
-    [[nodiscard]] constexpr _Tp lower_bound(node& id,
+    [[nodiscard]] constexpr _Tp lower_bound(const node& id,
                                             const _Tp& l,
                                             const _Tp& r,
                                             const _Tp& val) const {
@@ -309,7 +574,7 @@ class ordered_set_base {
      * @return Either said value or RB when all traversed nodes are either empty
      * or null (i.e. no such value exists).
      */
-    [[nodiscard]] constexpr _Tp upper_bound(node& id,
+    [[nodiscard]] constexpr _Tp upper_bound(const node& id,
                                             const _Tp& l,
                                             const _Tp& r,
                                             const _Tp& val) const {
@@ -324,6 +589,119 @@ class ordered_set_base {
 
         return NULL_NODE_MIN;
     }
+    /**
+     * @brief Answer rank queries for a sorted slice of values in one shared
+     * descent, so that path prefixes common to several queries are only
+     * visited once.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param first Start of a sorted slice of queries, all within `[l,r]`.
+     * @param last End of said slice.
+     * @param acc The number of elements less than @a l.
+     * @param out Answers, written at the same offsets as their queries.
+     * @param strict Count elements strictly less than (instead of not more
+     * than) each query.
+     */
+    void batch_rank(const node& id,
+                    const _Tp& l,
+                    const _Tp& r,
+                    const _Tp* first,
+                    const _Tp* last,
+                    size_t acc,
+                    size_t* out,
+                    bool strict) const {
+        if (first == last)
+            return;
+
+        // Queries entirely before or after the values of this node do not
+        // need to go any deeper.
+        const _Tp* below =
+            strict ? std::upper_bound(first, last, id.lowest_value)
+                   : std::lower_bound(first, last, id.lowest_value);
+        const _Tp* above =
+            strict ? std::upper_bound(below, last, id.highest_value)
+                   : std::lower_bound(below, last, id.highest_value);
+        if (id.cnt == 0)
+            below = above = last;
+        std::fill(out, out + (below - first), acc);
+        std::fill(out + (above - first), out + (last - first), acc + id.cnt);
+        out += below - first;
+        first = below, last = above;
+        if (first == last)
+            return;
+
+        if (l == r) {
+            // a query here is exactly l
+            std::fill(out, out + (last - first), acc + (strict ? 0 : id.cnt));
+            return;
+        }
+
+        _Tp mid = std::midpoint(l, r);
+        const _Tp* split = std::upper_bound(first, last, mid);
+        if (id.left_child != NULL_NODE)
+            batch_rank(*(id.left_child), l, mid, first, split, acc, out,
+                       strict);
+        else
+            std::fill(out, out + (split - first), acc);
+
+        acc += get_cnt(id.left_child);
+        out += split - first;
+        if (id.right_child != NULL_NODE)
+            batch_rank(*(id.right_child), mid + 1, r, split, last, acc, out,
+                       strict);
+        else
+            std::fill(out, out + (last - split), acc);
+    }
+
+    /**
+     * @brief Answer @c lower_bound queries for a sorted slice of values in one
+     * shared descent.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param first Start of a sorted slice of queries, all within `[l,r]`.
+     * @param last End of said slice.
+     * @param out Answers, written at the same offsets as their queries.
+     *
+     * @note Every query sent into a node either has its answer inside that
+     * node, or has no answer at all (i.e. RB).
+     */
+    void batch_lower_bound(const node& id,
+                           const _Tp& l,
+                           const _Tp& r,
+                           const _Tp* first,
+                           const _Tp* last,
+                           _Tp* out) const {
+        if (first == last)
+            return;
+        if (l == r || id.cnt == 0) {
+            std::fill(out, out + (last - first),
+                      id.cnt ? id.lowest_value : EMPTY_NODE_MIN);
+            return;
+        }
+
+        _Tp mid = std::midpoint(l, r);
+        const _Tp* split = std::upper_bound(first, last, mid);
+        const _Tp* inside_left =
+            get_cnt(id.left_child)
+                ? std::upper_bound(first, split, get_highest(id.left_child))
+                : first;
+        if (inside_left != first)
+            batch_lower_bound(*(id.left_child), l, mid, first, inside_left,
+                              out);
+        // the rest of the left half is answered by the right child's minimum
+        std::fill(out + (inside_left - first), out + (split - first),
+                  get_lowest(id.right_child));
+
+        out += split - first;
+        if (id.right_child != NULL_NODE)
+            batch_lower_bound(*(id.right_child), mid + 1, r, split, last, out);
+        else
+            std::fill(out, out + (last - split), NULL_NODE_MIN);
+    }
 };
 
 }  // namespace cpdsa
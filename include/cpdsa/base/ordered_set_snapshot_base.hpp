@@ -0,0 +1,347 @@
+/**
+ * CPDSA: Ordered set snapshots, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/ordered_set_snapshot_base.hpp
+ */
+
+#ifndef CPDSA_ORDERED_SET_SNAPSHOT_BASE
+#define CPDSA_ORDERED_SET_SNAPSHOT_BASE
+
+#include <algorithm>  // for std::min, std::max
+#include <concepts>   // for std::integral
+#include <cstdint>    // for std::uint32_t, std::uint64_t
+#include <cstdio>     // for std::FILE
+#include <cstring>    // for std::memcmp, std::memcpy
+#include <numeric>    // for std::midpoint
+#include <type_traits>
+#include <vector>
+
+#include "ordered_set_base.hpp"  // for ordered_set_sum_type
+
+namespace cpdsa {
+
+/**
+ * @brief Leading 64 bytes of a snapshot file, so that the records following
+ * it stay aligned once the file is mapped.
+ */
+struct ordered_set_snapshot_header {
+    // these should have been a simple enum but
+    // are also stored on disk so ...
+    enum SNAPSHOT_KINDS : std::uint32_t { TREE = 1, FLAT = 2 };
+
+    char magic[8];             // "CPDSAOS" and a format revision
+    std::uint32_t kind;        // see SNAPSHOT_KINDS
+    std::uint32_t value_size;  // sizeof(_Tp)
+    std::uint64_t lb, rb;      // the bounds, as raw bits
+    std::uint64_t records;     // the number of records following
+    char reserved[24];
+
+    static constexpr char MAGIC[8] = {'C', 'P', 'D', 'S', 'A', 'O', 'S', '1'};
+};
+static_assert(sizeof(ordered_set_snapshot_header) == 64);
+
+/**
+ * @brief A node of the tree backend, with children as record indices.
+ *
+ * @note Records are in preorder, so the root is record 0 and 0 can stand for
+ * a missing child.
+ */
+template <std::integral _Tp>
+struct ordered_set_snapshot_node {
+    ordered_set_sum_type<_Tp> sum;
+    std::int32_t cnt;
+    std::uint32_t left_child;
+    std::uint32_t right_child;
+    _Tp lowest_value;
+    _Tp highest_value;
+};
+
+/**
+ * @brief Snapshot file handling, and queries answered straight from an array
+ * of records.
+ */
+template <std::integral _Tp, _Tp LB, _Tp RB>
+class ordered_set_snapshot_base {
+   public:
+    // file handling is shared with ordered_set, hence public
+    using header_type = ordered_set_snapshot_header;
+    using record_type = ordered_set_snapshot_node<_Tp>;
+
+    static constexpr std::uint32_t NULL_RECORD = 0;
+
+    [[nodiscard]] static header_type make_header(std::uint32_t kind,
+                                                 std::uint64_t records) {
+        header_type header{};
+        std::memcpy(header.magic, header_type::MAGIC, sizeof(header.magic));
+        header.kind = kind;
+        header.value_size = sizeof(_Tp);
+        header.lb = static_cast<std::make_unsigned_t<_Tp>>(LB);
+        header.rb = static_cast<std::make_unsigned_t<_Tp>>(RB);
+        header.records = records;
+        return header;
+    }
+
+    /**
+     * @brief Returns whether a header was written by a container of this very
+     * type, for @c record_size bytes per record, into a file of
+     * @c file_size bytes.
+     */
+    [[nodiscard]] static bool check_header(const header_type& header,
+                                           std::uint32_t kind,
+                                           size_t record_size,
+                                           size_t file_size) {
+        const header_type expected = make_header(kind, header.records);
+        return std::memcmp(header.magic, expected.magic,
+                           sizeof(header.magic)) == 0 &&
+               header.kind == kind && header.value_size == sizeof(_Tp) &&
+               header.lb == expected.lb && header.rb == expected.rb &&
+               file_size >= sizeof(header_type) &&
+               (file_size - sizeof(header_type)) / record_size ==
+                   header.records &&
+               (file_size - sizeof(header_type)) % record_size == 0;
+    }
+
+    /**
+     * @brief Write a header and the given arrays to @c path.
+     *
+     * @return False on any I/O error.
+     */
+    template <typename... _Arrays>
+    static bool write_file(const char* path,
+                           const header_type& header,
+                           const _Arrays&... arrays) {
+        std::FILE* file = std::fopen(path, "wb");
+        if (file == nullptr)
+            return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ((ok = ok && std::fwrite(arrays.data(), sizeof(arrays[0]),
+                                 arrays.size(), file) == arrays.size()),
+         ...);
+        return std::fclose(file) == 0 && ok;
+    }
+
+    /**
+     * @brief Read the header of @c path, check it (see @c check_header) and
+     * read the arrays following it, each sized beforehand by
+     * @c size_arrays(records), which returns false to reject the file.
+     *
+     * @return False on any I/O error or mismatch, leaving the arrays in an
+     * unspecified state.
+     */
+    template <typename _Sizer, typename... _Arrays>
+    static bool read_file(const char* path,
+                          std::uint32_t kind,
+                          size_t record_size,
+                          _Sizer size_arrays,
+                          _Arrays&... arrays) {
+        std::FILE* file = std::fopen(path, "rb");
+        if (file == nullptr)
+            return false;
+        header_type header;
+        bool ok = std::fseek(file, 0, SEEK_END) == 0;
+        const long file_size = ok ? std::ftell(file) : -1;
+        ok = ok && file_size >= 0 && std::fseek(file, 0, SEEK_SET) == 0 &&
+             std::fread(&header, sizeof(header), 1, file) == 1 &&
+             check_header(header, kind, record_size, file_size);
+        ok = ok && size_arrays(header.records);
+        ((ok = ok && std::fread(arrays.data(), sizeof(arrays[0]),
+                                arrays.size(), file) == arrays.size()),
+         ...);
+        std::fclose(file);
+        return ok;
+    }
+
+    /**
+     * @brief Returns whether @c n records form the tree @c flatten writes:
+     * every child index points past its parent, in preorder, within the
+     * records, and every record's count and bounds agree with its range and
+     * its children. Queries and @c unflatten trust all of this.
+     */
+    [[nodiscard]] static bool check_records(const record_type* nodes,
+                                            std::uint64_t n) {
+        struct frame {
+            std::uint32_t id;
+            _Tp l, r;
+        };
+        std::vector<frame> stack{{0, LB, RB}};
+        std::uint64_t next = 0;  // preorder index of the next record visited
+        while (!stack.empty()) {
+            const frame f = stack.back();
+            stack.pop_back();
+            if (f.id != next++ || f.id >= n)
+                return false;
+            const record_type& cur = nodes[f.id];
+            // only the root may be empty
+            if (cur.cnt < 0 || (f.id != 0 && cur.cnt == 0))
+                return false;
+            if (cur.cnt != 0 &&
+                (cur.lowest_value < f.l || f.r < cur.highest_value ||
+                 cur.highest_value < cur.lowest_value))
+                return false;
+            const std::uint32_t children[2] = {cur.left_child,
+                                               cur.right_child};
+            if (f.l == f.r) {
+                if (children[0] != NULL_RECORD || children[1] != NULL_RECORD ||
+                    (cur.cnt != 0 && cur.lowest_value != f.l))
+                    return false;
+                continue;
+            }
+            long long cnt = 0;
+            _Tp lowest = RB, highest = LB;
+            for (std::uint32_t child : children) {
+                if (child == NULL_RECORD)
+                    continue;
+                if (child <= f.id || child >= n)
+                    return false;
+                cnt += nodes[child].cnt;
+                lowest = std::min(lowest, nodes[child].lowest_value);
+                highest = std::max(highest, nodes[child].highest_value);
+            }
+            if (cnt != cur.cnt ||
+                (cnt != 0 && (lowest != cur.lowest_value ||
+                              highest != cur.highest_value)))
+                return false;
+            const _Tp mid = std::midpoint(f.l, f.r);
+            if (cur.right_child != NULL_RECORD)
+                stack.push_back({cur.right_child, mid + 1, f.r});
+            if (cur.left_child != NULL_RECORD)
+                stack.push_back({cur.left_child, f.l, mid});
+        }
+        return next == n;
+    }
+
+   protected:
+    /**
+     * @brief Returns child @c c of record @c id out of @c n, or
+     * @c NULL_RECORD if it is missing or could not be one (see
+     * @c check_records).
+     *
+     * @note Queries follow children through this and carry the range of
+     * each record, stopping at single values, so that even on unchecked
+     * records they stay in bounds and take @a O(log(RB - LB)).
+     */
+    [[nodiscard]] static std::uint32_t child(std::uint32_t id,
+                                             std::uint32_t c,
+                                             std::uint64_t n) noexcept {
+        return c > id && c < n ? c : NULL_RECORD;
+    }
+
+    /**
+     * @brief Returns the number of elements under a record, of range
+     * `[l,r]`, in the range `[u,v]`.
+     */
+    [[nodiscard]] static int get(const record_type* nodes,
+                                 std::uint64_t n,
+                                 std::uint32_t id,
+                                 _Tp l,
+                                 _Tp r,
+                                 _Tp u,
+                                 _Tp v) noexcept {
+        const record_type& cur = nodes[id];
+        if (cur.cnt == 0 || cur.highest_value < u || v < cur.lowest_value ||
+            r < u || v < l)
+            return 0;
+        if ((u <= cur.lowest_value && cur.highest_value <= v) ||
+            (u <= l && r <= v) || l == r)
+            return cur.cnt;
+
+        const _Tp mid = std::midpoint(l, r);
+        int result = 0;
+        if (std::uint32_t c = child(id, cur.left_child, n))
+            result += get(nodes, n, c, l, mid, u, v);
+        if (std::uint32_t c = child(id, cur.right_child, n))
+            result += get(nodes, n, c, mid + 1, r, u, v);
+        return result;
+    }
+
+    /**
+     * @brief Find the value of the k-th smallest (1-based) element, with
+     * @c k at most the size of the set.
+     *
+     * @return Either said value or RB if the records disagree with @c k.
+     */
+    [[nodiscard]] static _Tp k_largest(const record_type* nodes,
+                                       std::uint64_t n,
+                                       size_t k) noexcept {
+        std::uint32_t id = 0;
+        _Tp l = LB, r = RB;
+        while (l != r) {
+            _Tp mid = std::midpoint(l, r);
+            const record_type& cur = nodes[id];
+            const std::uint32_t left = child(id, cur.left_child, n);
+            size_t left_cnt = left != NULL_RECORD ? nodes[left].cnt : 0;
+            if (left_cnt >= k) {
+                id = left;
+                r = mid;
+            } else {
+                k -= left_cnt;
+                id = child(id, cur.right_child, n);
+                l = mid + 1;
+            }
+            if (id == NULL_RECORD)
+                return RB;
+        }
+        return l;
+    }
+
+    /**
+     * @brief Find the smallest value under a record, of range `[l,r]`, not
+     * less than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] static _Tp lower_bound(const record_type* nodes,
+                                         std::uint64_t n,
+                                         std::uint32_t id,
+                                         _Tp l,
+                                         _Tp r,
+                                         const _Tp& val) noexcept {
+        const record_type& cur = nodes[id];
+        if (cur.cnt == 0 || cur.highest_value < val)
+            return RB;
+        if (val <= cur.lowest_value)
+            return cur.lowest_value;
+        if (l == r)
+            return RB;
+        const _Tp mid = std::midpoint(l, r);
+        const std::uint32_t left = child(id, cur.left_child, n);
+        if (left != NULL_RECORD && nodes[left].highest_value >= val)
+            return lower_bound(nodes, n, left, l, mid, val);
+        const std::uint32_t right = child(id, cur.right_child, n);
+        return right != NULL_RECORD
+                   ? lower_bound(nodes, n, right, mid + 1, r, val)
+                   : RB;
+    }
+
+    /**
+     * @brief Find the largest value under a record, of range `[l,r]`, not
+     * more than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] static _Tp upper_bound(const record_type* nodes,
+                                         std::uint64_t n,
+                                         std::uint32_t id,
+                                         _Tp l,
+                                         _Tp r,
+                                         const _Tp& val) noexcept {
+        const record_type& cur = nodes[id];
+        if (cur.cnt == 0 || val < cur.lowest_value)
+            return RB;
+        if (cur.highest_value <= val)
+            return cur.highest_value;
+        if (l == r)
+            return RB;
+        const _Tp mid = std::midpoint(l, r);
+        const std::uint32_t right = child(id, cur.right_child, n);
+        if (right != NULL_RECORD && nodes[right].lowest_value <= val)
+            return upper_bound(nodes, n, right, mid + 1, r, val);
+        const std::uint32_t left = child(id, cur.left_child, n);
+        return left != NULL_RECORD ? upper_bound(nodes, n, left, l, mid, val)
+                                   : RB;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_ORDERED_SET_SNAPSHOT_BASE */
@@ -0,0 +1,269 @@
+/**
+ * CPDSA: Parallel direction-optimizing BFS, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/parallel_bfs_base.hpp
+ */
+
+#ifndef CPDSA_PARALLEL_BFS_BASE
+#define CPDSA_PARALLEL_BFS_BASE
+
+#include <algorithm>  // for std::copy, std::min
+#include <atomic>
+#include <barrier>
+#include <bit>  // for std::countr_zero
+#include <cstddef>
+#include <cstdint>  // for std::uint64_t
+#include <thread>
+#include <utility>  // for std::swap
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for parallel_bfs.
+ *
+ * @note Each level is expanded either top-down, every frontier vertex
+ * claiming its unvisited neighbors with an atomic @c fetch_or on the visited
+ * bitmap, or bottom-up, every unvisited vertex looking for a parent in the
+ * frontier bitmap among its incoming neighbors and stopping at the first.
+ * Bottom-up levels skip most arcs once the frontier is a good part of the
+ * graph (Beamer et al.): the search switches to them when the arcs leaving
+ * the frontier outnumber those leaving unvisited vertices divided by
+ * @c ALPHA, and back once the frontier has fewer than @a n / @c BETA vertices.
+ *
+ * @note Threads take work in chunks from a shared atomic cursor, and collect
+ * what they discover in queues of their own. Between levels, they copy those
+ * queues into the next frontier (or its bitmap) at offsets computed from
+ * their sizes, so nothing runs on one thread for longer than @a O(threads).
+ */
+template <typename _Graph>
+class parallel_bfs_base {
+   private:
+    using vertex_type = typename _Graph::vertex_type;
+    using word_type = std::uint64_t;
+
+    static constexpr vertex_type UNREACHED = _Graph::UNREACHED;
+    static constexpr std::size_t ALPHA = 14;
+    static constexpr std::size_t BETA = 24;
+    static constexpr std::size_t WORD_BITS = 64;
+    static constexpr std::size_t TOP_DOWN_CHUNK = 64;   // frontier vertices
+    static constexpr std::size_t BOTTOM_UP_CHUNK = 16;  // bitmap words
+
+    const _Graph& out;  // arcs followed top-down
+    const _Graph& in;   // arcs followed bottom-up
+    const std::size_t n, words, threads;
+
+    std::vector<vertex_type> dist;
+    std::vector<std::atomic<word_type>> visited, front, next;
+    std::vector<vertex_type> queue;  // the frontier, top-down
+    std::size_t queue_size = 0;
+
+    struct alignas(64) local_queue {
+        std::vector<vertex_type> found;
+        std::size_t found_arcs = 0;  // their out-degrees
+        std::size_t offset = 0;      // where they go in queue
+    };
+
+    std::vector<local_queue> locals;
+
+    alignas(64) std::atomic<std::size_t> cursor{0};
+    std::size_t unexplored_arcs = 0;
+    vertex_type depth = 0;
+    bool bottom_up = false, was_bottom_up = false;
+    bool expanding = true, done = false;
+
+    void discover(local_queue& l, vertex_type v) {
+        dist[v] = depth + 1;
+        l.found.push_back(v);
+        l.found_arcs += out.degree(v);
+    }
+
+    void expand_top_down(local_queue& l) {
+        for (;;) {
+            const std::size_t first =
+                cursor.fetch_add(TOP_DOWN_CHUNK, std::memory_order_relaxed);
+            if (first >= queue_size)
+                return;
+            const std::size_t last =
+                std::min(first + TOP_DOWN_CHUNK, queue_size);
+            for (std::size_t i = first; i < last; ++i)
+                for (vertex_type u : out.neighbors(queue[i])) {
+                    std::atomic<word_type>& w = visited[u / WORD_BITS];
+                    const word_type bit = word_type(1) << (u % WORD_BITS);
+                    // most neighbors are already visited: check before
+                    // paying for the read-modify-write
+                    if (w.load(std::memory_order_relaxed) & bit ||
+                        w.fetch_or(bit, std::memory_order_relaxed) & bit)
+                        continue;
+                    discover(l, u);
+                }
+        }
+    }
+
+    void expand_bottom_up(local_queue& l) {
+        for (;;) {
+            const std::size_t first =
+                cursor.fetch_add(BOTTOM_UP_CHUNK, std::memory_order_relaxed);
+            if (first >= words)
+                return;
+            const std::size_t last = std::min(first + BOTTOM_UP_CHUNK, words);
+            // whole words per chunk: this thread alone writes them
+            for (std::size_t i = first; i < last; ++i) {
+                word_type todo = ~visited[i].load(std::memory_order_relaxed);
+                if (i == words - 1 && n % WORD_BITS)
+                    todo &= (word_type(1) << (n % WORD_BITS)) - 1;
+                word_type found = 0;
+                for (; todo; todo &= todo - 1) {
+                    const vertex_type v =
+                        i * WORD_BITS + std::countr_zero(todo);
+                    for (vertex_type u : in.neighbors(v))
+                        if (front[u / WORD_BITS].load(
+                                std::memory_order_relaxed) >>
+                                (u % WORD_BITS) &
+                            1) {
+                            found |= todo & -todo;
+                            discover(l, v);
+                            break;
+                        }
+                }
+                if (found) {
+                    visited[i].fetch_or(found, std::memory_order_relaxed);
+                    next[i].store(found, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Lay out the next frontier in the form the next level expects.
+     * Bitmaps are kept clear while the search runs top-down.
+     */
+    void publish(std::size_t t) {
+        const local_queue& l = locals[t];
+        const std::size_t first = words * t / threads;
+        const std::size_t last = words * (t + 1) / threads;
+        if (!bottom_up) {
+            std::copy(l.found.begin(), l.found.end(),
+                      queue.begin() + l.offset);
+            if (was_bottom_up)
+                for (std::size_t i = first; i < last; ++i) {
+                    front[i].store(0, std::memory_order_relaxed);
+                    next[i].store(0, std::memory_order_relaxed);
+                }
+        } else if (!was_bottom_up) {
+            for (vertex_type v : l.found)
+                front[v / WORD_BITS].fetch_or(word_type(1) << (v % WORD_BITS),
+                                              std::memory_order_relaxed);
+        } else {
+            // next is the new frontier, swapped in once every thread is done
+            for (std::size_t i = first; i < last; ++i)
+                front[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Runs on one thread between the expansion of a level and the
+     * publication of its frontier, and decides the next direction.
+     */
+    void plan() noexcept {
+        std::size_t found = 0, found_arcs = 0;
+        for (local_queue& l : locals) {
+            l.offset = found;
+            found += l.found.size();
+            found_arcs += l.found_arcs;
+        }
+        if (!found) {
+            done = true;
+            return;
+        }
+        unexplored_arcs -= found_arcs;
+        was_bottom_up = bottom_up;
+        if (bottom_up)
+            bottom_up = found >= n / BETA;
+        else
+            bottom_up = found_arcs > unexplored_arcs / ALPHA;
+        queue_size = found;
+    }
+
+    /**
+     * @brief Runs on one thread once the next frontier is published.
+     */
+    void next_level() noexcept {
+        if (bottom_up && was_bottom_up)
+            std::swap(front, next);
+        for (local_queue& l : locals) {
+            l.found.clear();
+            l.found_arcs = 0;
+        }
+        cursor.store(0, std::memory_order_relaxed);
+        ++depth;
+    }
+
+    template <typename _Barrier>
+    void work(std::size_t t, _Barrier& sync) {
+        local_queue& l = locals[t];
+        for (;;) {
+            if (bottom_up)
+                expand_bottom_up(l);
+            else
+                expand_top_down(l);
+            sync.arrive_and_wait();
+            if (done)
+                return;
+            publish(t);
+            sync.arrive_and_wait();
+        }
+    }
+
+   public:
+    /**
+     * @brief Prepare a search over @c out_, whose transpose is @c in_, with
+     * @c threads_ threads.
+     */
+    parallel_bfs_base(const _Graph& out_, const _Graph& in_,
+                      std::size_t threads_)
+        : out(out_),
+          in(in_),
+          n(out_.vertex_count()),
+          words((n + WORD_BITS - 1) / WORD_BITS),
+          threads(threads_ ? threads_ : 1),
+          dist(n, UNREACHED),
+          visited(words),
+          front(words),
+          next(words),
+          queue(n),
+          locals(threads) {}
+
+    /**
+     * @brief Returns the number of arcs on a shortest path from @c source to
+     * every vertex, or @c UNREACHED.
+     */
+    std::vector<vertex_type> search(vertex_type source) {
+        dist[source] = 0;
+        visited[source / WORD_BITS].store(word_type(1)
+                                          << (source % WORD_BITS));
+        queue[0] = source;
+        queue_size = 1;
+        unexplored_arcs = out.edge_count() - out.degree(source);
+
+        auto complete = [this]() noexcept {
+            if (expanding)
+                plan();
+            else
+                next_level();
+            expanding = !expanding;
+        };
+        std::barrier sync(threads, complete);
+        std::vector<std::thread> pool;
+        for (std::size_t t = 1; t < threads; ++t)
+            pool.emplace_back([this, t, &sync] { work(t, sync); });
+        work(0, sync);
+        for (std::thread& th : pool)
+            th.join();
+        return std::move(dist);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_PARALLEL_BFS_BASE */
@@ -0,0 +1,285 @@
+/**
+ * CPDSA: Persistent ordered set, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/persistent_ordered_set_base.hpp
+ */
+
+#ifndef CPDSA_PERSISTENT_ORDERED_SET_BASE
+#define CPDSA_PERSISTENT_ORDERED_SET_BASE
+
+#include <algorithm>  // for std::min, std::max
+#include <concepts>   // for std::integral
+#include <cstdint>    // for std::uint32_t
+#include <numeric>    // for std::midpoint
+#include <vector>
+
+#include "ordered_set_base.hpp"  // for ordered_set_sum_type
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for persistent_ordered_set.
+ *
+ * @note Same dynamic segment tree as @c ordered_set_base, but nodes are never
+ * modified in place: every update copies the root-to-leaf path it touches, so
+ * older roots keep describing older versions. Since nodes are shared between
+ * versions they live in one pool and refer to each other by index, with index
+ * 0 being the null node.
+ */
+template <std::integral _Tp, _Tp LB, _Tp RB>
+class persistent_ordered_set_base {
+   private:
+    static const int NULL_NODE_COUNT = 0;
+    static const int NULL_NODE_SUM = 0;
+    static constexpr _Tp NULL_NODE_MIN = RB;
+    static constexpr _Tp NULL_NODE_MAX = LB;
+
+    static const int EMPTY_NODE_COUNT = 0;
+    static const int EMPTY_NODE_SUM = 0;
+    static constexpr _Tp EMPTY_NODE_MIN = RB;
+    static constexpr _Tp EMPTY_NODE_MAX = LB;
+
+   protected:
+    using index_type = std::uint32_t;
+    using sum_type = ordered_set_sum_type<_Tp>;
+
+    static constexpr index_type NULL_NODE = 0;
+
+    /**
+     * @brief Node implementation.
+     */
+    struct node {
+        int cnt;            // the amount of elements currently in the node ...
+        sum_type sum;       // ... and their sum.
+        _Tp lowest_value;   // Value bounds for the node.
+        _Tp highest_value;  // An uninstantiated or null node has
+                            // lowest_value = RB and highest_value = LB as
+                            // obvious placeholders.
+        index_type left_child;
+        index_type right_child;  // left and right child, as pool indices
+
+        node()
+            : cnt(EMPTY_NODE_COUNT),
+              sum(EMPTY_NODE_SUM),
+              lowest_value(EMPTY_NODE_MIN),
+              highest_value(EMPTY_NODE_MAX),
+              left_child(NULL_NODE),
+              right_child(NULL_NODE) {}
+    };
+
+    // these should have been a simple enum but
+    // are also used by child classes so ...
+    enum NODE_UPDATE_ACTIONS { ADD_ONCE, REMOVE_ONCE, REMOVE_ALL };
+
+    std::vector<node> pool;
+
+    persistent_ordered_set_base() : pool(1) {}
+
+    /**
+     * @brief Drop every node except the null node.
+     */
+    void reset() { pool.assign(1, node()); }
+
+    /**
+     * @brief Update the state of a (copied) leaf node.
+     *
+     * @param leaf The current node.
+     * @param val Value being updated.
+     * @param action Action specified (see @c NODE_UPDATE_ACTIONS)
+     */
+    constexpr void update_leaf(node& leaf, const _Tp& val, int action) {
+        switch (action) {
+            case NODE_UPDATE_ACTIONS::ADD_ONCE:
+                leaf.cnt++;
+                leaf.sum += val;
+                break;
+            case NODE_UPDATE_ACTIONS::REMOVE_ONCE:
+                leaf.cnt--;
+                leaf.sum -= val;
+                break;
+            case NODE_UPDATE_ACTIONS::REMOVE_ALL:
+                leaf.cnt = 0;
+                leaf.sum = 0;
+                break;
+            default:
+                break;
+        }
+
+        leaf.lowest_value = (leaf.cnt ? val : EMPTY_NODE_MIN);
+        leaf.highest_value = (leaf.cnt ? val : EMPTY_NODE_MAX);
+    }
+
+    /**
+     * @brief Update values of a (copied) node by propagating from its childs.
+     *
+     * @param id The current node.
+     */
+    constexpr void update_from_childs(node& id) const {
+        const node& left = pool[id.left_child];
+        const node& right = pool[id.right_child];
+        id.cnt = left.cnt + right.cnt;
+        id.sum = left.sum + right.sum;
+        id.lowest_value = std::min(left.lowest_value, right.lowest_value);
+        id.highest_value = std::max(left.highest_value, right.highest_value);
+    }
+
+    /**
+     * @brief Create the new version of a node and of all its descendants
+     * containing @c val.
+     *
+     * @param id The current node in the old version.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param val Value being updated.
+     * @param action Action specified (see @c NODE_UPDATE_ACTIONS)
+     *
+     * @return The index of the node in the new version. Removing from an empty
+     * node changes nothing, so that node is shared instead of copied.
+     */
+    index_type update(index_type id,
+                      const _Tp& l,
+                      const _Tp& r,
+                      const _Tp& val,
+                      int action) {
+        if (pool[id].cnt == 0 && action != NODE_UPDATE_ACTIONS::ADD_ONCE)
+            return id;
+
+        node copy = pool[id];  // not a reference, pool may grow below
+        if (l == r) {
+            update_leaf(copy, val, action);
+        } else {
+            _Tp mid = std::midpoint(l, r);
+            if (val <= mid)
+                copy.left_child = update(copy.left_child, l, mid, val, action);
+            else
+                copy.right_child =
+                    update(copy.right_child, mid + 1, r, val, action);
+            update_from_childs(copy);
+        }
+
+        pool.push_back(copy);
+        return static_cast<index_type>(pool.size() - 1);
+    }
+
+    /**
+     * @brief Returns the number of elements in the range `[u,v]` that are in
+     * node @c hi but not in node @c lo.
+     *
+     * @param hi The current node in the newer version.
+     * @param lo The current node in the older version (or the null node).
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param u Left boundary of the query range.
+     * @param v Right boundary of the query range.
+     */
+    [[nodiscard]] int get(index_type hi,
+                          index_type lo,
+                          const _Tp& l,
+                          const _Tp& r,
+                          _Tp u,
+                          _Tp v) const {
+        const node& h = pool[hi];
+        if (h.cnt == pool[lo].cnt || h.highest_value < u ||
+            v < h.lowest_value)
+            return NULL_NODE_COUNT;
+        if (u <= l && r <= v)
+            return h.cnt - pool[lo].cnt;
+
+        _Tp mid = std::midpoint(l, r);
+        return get(h.left_child, pool[lo].left_child, l, mid, u, v) +
+               get(h.right_child, pool[lo].right_child, mid + 1, r, u, v);
+    }
+
+    /**
+     * @brief Find the value of the k-th smallest (1-based) element among the
+     * ones in node @c hi but not in node @c lo.
+     *
+     * @param hi The current node in the newer version.
+     * @param lo The current node in the older version (or the null node).
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param k The position to find.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp k_largest(index_type hi,
+                                index_type lo,
+                                _Tp l,
+                                _Tp r,
+                                size_t k) const {
+        if (static_cast<size_t>(pool[hi].cnt - pool[lo].cnt) < k)
+            return NULL_NODE_MIN;
+
+        while (l != r) {
+            _Tp mid = std::midpoint(l, r);
+            size_t left_cnt = pool[pool[hi].left_child].cnt -
+                              pool[pool[lo].left_child].cnt;
+            if (left_cnt >= k) {
+                hi = pool[hi].left_child, lo = pool[lo].left_child;
+                r = mid;
+            } else {
+                hi = pool[hi].right_child, lo = pool[lo].right_child;
+                l = mid + 1;
+                k -= left_cnt;
+            }
+        }
+        return l;
+    }
+
+    /**
+     * @brief Find the smallest value in a node not less than @c val.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param val Value to compare against.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp lower_bound(index_type id,
+                                  const _Tp& l,
+                                  const _Tp& r,
+                                  const _Tp& val) const {
+        const node& cur = pool[id];
+        if (cur.highest_value < val)
+            return NULL_NODE_MIN;
+        if (val <= cur.lowest_value || l == r)
+            return cur.lowest_value;
+
+        _Tp mid = std::midpoint(l, r);
+        if (pool[cur.left_child].highest_value >= val)
+            return lower_bound(cur.left_child, l, mid, val);
+        return lower_bound(cur.right_child, mid + 1, r, val);
+    }
+
+    /**
+     * @brief Find the largest value in a node not more than @c val.
+     *
+     * @param id The current node.
+     * @param l Left boundary of the node's range.
+     * @param r Right boundary of the node's range.
+     * @param val Value to compare against.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp upper_bound(index_type id,
+                                  const _Tp& l,
+                                  const _Tp& r,
+                                  const _Tp& val) const {
+        const node& cur = pool[id];
+        if (cur.cnt == 0 || val < cur.lowest_value)
+            return NULL_NODE_MIN;
+        if (cur.highest_value <= val || l == r)
+            return cur.highest_value;
+
+        _Tp mid = std::midpoint(l, r);
+        const node& right = pool[cur.right_child];
+        if (right.cnt && right.lowest_value <= val)
+            return upper_bound(cur.right_child, mid + 1, r, val);
+        return upper_bound(cur.left_child, l, mid, val);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_PERSISTENT_ORDERED_SET_BASE */
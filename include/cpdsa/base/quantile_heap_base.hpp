@@ -0,0 +1,558 @@
+/**
+ * CPDSA: Two-heap order statistics, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/quantile_heap_base.hpp
+ */
+
+#ifndef CPDSA_QUANTILE_HEAP_BASE
+#define CPDSA_QUANTILE_HEAP_BASE
+
+#include <algorithm>   // for std::nth_element
+#include <cstddef>     // for std::size_t
+#include <functional>  // for std::less, std::greater, std::hash
+#include <type_traits>
+#include <unordered_map>
+#include <utility>     // for std::move
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Whether @c _Tp can be erased lazily, which keeps erased elements in
+ * a @c std::unordered_map: it needs @c std::hash<_Tp> and @c operator==.
+ */
+template <typename, typename = void>
+struct is_lazily_erasable : std::false_type {};
+
+template <typename _Tp>
+struct is_lazily_erasable<
+    _Tp,
+    typename std::enable_if<
+        std::is_convertible<
+            decltype(std::hash<_Tp>()(std::declval<const _Tp&>())),
+            std::size_t>::value &&
+        std::is_convertible<decltype(std::declval<const _Tp&>() ==
+                                     std::declval<const _Tp&>()),
+                            bool>::value>::type> : std::true_type {};
+
+/**
+ * @brief A @a _Arity-ary heap over one contiguous array, with the largest
+ * element (according to @c _Compare) on top, like @c std::priority_queue.
+ *
+ * @note Wider nodes make the heap shallower: a sift-down touches
+ * @a log_d(n) levels, each scanning @a d adjacent children that share a
+ * cache line or two, which beats a binary heap once the array outgrows the
+ * cache.
+ */
+template <typename _Tp, typename _Compare, std::size_t _Arity>
+class d_ary_heap {
+   private:
+    static_assert(_Arity >= 2, "heap nodes must have at least two children");
+
+    std::vector<_Tp> c;
+    _Compare comp;
+
+    void sift_up(std::size_t i) {
+        _Tp x = std::move(c[i]);
+        while (i > 0) {
+            std::size_t parent = (i - 1) / _Arity;
+            if (!comp(c[parent], x))
+                break;
+            c[i] = std::move(c[parent]);
+            i = parent;
+        }
+        c[i] = std::move(x);
+    }
+
+    void sift_down(std::size_t i) {
+        const std::size_t n = c.size();
+        _Tp x = std::move(c[i]);
+        for (;;) {
+            std::size_t first = i * _Arity + 1;
+            if (first >= n)
+                break;
+            std::size_t last = first + _Arity < n ? first + _Arity : n;
+            std::size_t best = first;
+            for (std::size_t j = first + 1; j < last; ++j)
+                if (comp(c[best], c[j]))
+                    best = j;
+            if (!comp(x, c[best]))
+                break;
+            c[i] = std::move(c[best]);
+            i = best;
+        }
+        c[i] = std::move(x);
+    }
+
+   public:
+    [[nodiscard]] const _Tp& top() const { return c.front(); }
+    [[nodiscard]] std::size_t size() const { return c.size(); }
+    [[nodiscard]] bool empty() const { return c.empty(); }
+
+    void push(const _Tp& x) {
+        c.push_back(x);
+        sift_up(c.size() - 1);
+    }
+
+    void pop() {
+        c.front() = std::move(c.back());
+        c.pop_back();
+        if (!c.empty())
+            sift_down(0);
+    }
+
+    /**
+     * @brief Push @c x then pop the top, returning it, with a single
+     * sift-down.
+     */
+    _Tp push_pop(const _Tp& x) {
+        if (c.empty() || !comp(x, c.front()))
+            return x;
+        _Tp top = std::move(c.front());
+        c.front() = x;
+        sift_down(0);
+        return top;
+    }
+
+    void reserve(std::size_t n) { c.reserve(n); }
+
+    /**
+     * @brief Remove every element, in @a O(1) for trivially destructible
+     * types. The memory is kept.
+     */
+    void clear() { c.clear(); }
+
+    /**
+     * @brief Replace the contents of the heap with `[first, last)`, in
+     * @a O(n).
+     */
+    template <typename _InputIt>
+    void assign(_InputIt first, _InputIt last) {
+        c.assign(first, last);
+        heapify();
+    }
+
+    /**
+     * @brief Restore the heap property over the whole array, in @a O(n).
+     */
+    void heapify() {
+        if (c.size() < 2)
+            return;
+        for (std::size_t i = (c.size() - 2) / _Arity + 1; i-- > 0;)
+            sift_down(i);
+    }
+
+    /**
+     * @brief Drop every element counted in @c delayed and re-heapify, in
+     * @a O(n).
+     */
+    template <typename _Map>
+    void compact(_Map& delayed) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < c.size(); ++i) {
+            typename _Map::iterator it = delayed.find(c[i]);
+            if (it == delayed.end()) {
+                c[kept++] = std::move(c[i]);
+            } else if (--it->second == 0) {
+                delayed.erase(it);
+            }
+        }
+        c.resize(kept);
+        heapify();
+    }
+};
+
+/**
+ * @brief A double-ended heap over one contiguous array: both the smallest
+ * and the largest element are on top.
+ *
+ * @note An interval heap (van Leeuwen and Wood, 1993), with @a _Arity
+ * children per node: node @a k holds @c c[2k] <= @c c[2k+1], and its
+ * interval is contained in its parent's, so the lows form a min-heap and the
+ * highs a max-heap. The last node may hold a single element, which counts as
+ * both. @c push and either pop take @a O(log(n)), with no memory besides the
+ * elements; as in @c d_ary_heap, the children of a node share a cache line or
+ * two.
+ */
+template <typename _Tp, std::size_t _Arity>
+class interval_heap {
+   private:
+    static_assert(_Arity >= 2, "heap nodes must have at least two children");
+
+    std::vector<_Tp> c;
+
+    [[nodiscard]] static std::size_t parent(std::size_t k) {
+        return (k - 1) / _Arity;
+    }
+
+    // the slot of the largest element of node k
+    [[nodiscard]] std::size_t high(std::size_t k) const {
+        return 2 * k + 1 < c.size() ? 2 * k + 1 : 2 * k;
+    }
+
+    // order the two elements of node k, if it has two
+    void order(std::size_t k) {
+        if (2 * k + 1 < c.size() && c[2 * k + 1] < c[2 * k])
+            std::swap(c[2 * k], c[2 * k + 1]);
+    }
+
+    // move the element at slot i (of node k = i / 2) up among the lows, or
+    // among the highs with _High
+    template <bool _High>
+    void sift_up(std::size_t i) {
+        _Tp x = std::move(c[i]);
+        std::size_t k = i / 2;
+        while (k > 0) {
+            const std::size_t to = 2 * parent(k) + _High;
+            if (_High ? !(c[to] < x) : !(x < c[to]))
+                break;
+            c[i] = std::move(c[to]);
+            i = to;
+            k = parent(k);
+        }
+        c[i] = std::move(x);
+    }
+
+    void sift_down_min(std::size_t k) {
+        const std::size_t n = c.size();
+        for (;;) {
+            const std::size_t first = _Arity * k + 1;
+            if (2 * first >= n)
+                break;
+            const std::size_t last =
+                first + _Arity < (n + 1) / 2 ? first + _Arity : (n + 1) / 2;
+            std::size_t best = first;
+            for (std::size_t j = first + 1; j < last; ++j)
+                if (c[2 * j] < c[2 * best])
+                    best = j;
+            if (!(c[2 * best] < c[2 * k]))
+                break;
+            std::swap(c[2 * k], c[2 * best]);
+            order(best);
+            k = best;
+        }
+    }
+
+    void sift_down_max(std::size_t k) {
+        const std::size_t n = c.size();
+        for (;;) {
+            const std::size_t first = _Arity * k + 1;
+            if (2 * first >= n)
+                break;
+            const std::size_t last =
+                first + _Arity < (n + 1) / 2 ? first + _Arity : (n + 1) / 2;
+            std::size_t best = first;
+            for (std::size_t j = first + 1; j < last; ++j)
+                if (c[high(best)] < c[high(j)])
+                    best = j;
+            if (!(c[2 * k + 1] < c[high(best)]))
+                break;
+            std::swap(c[2 * k + 1], c[high(best)]);
+            order(best);
+            k = best;
+        }
+    }
+
+   public:
+    [[nodiscard]] const _Tp& min() const { return c.front(); }
+    [[nodiscard]] const _Tp& max() const { return c[high(0)]; }
+    [[nodiscard]] std::size_t size() const { return c.size(); }
+    [[nodiscard]] bool empty() const { return c.empty(); }
+
+    void push(const _Tp& x) {
+        c.push_back(x);
+        const std::size_t i = c.size() - 1;
+        if (i & 1) {  // second element of its node
+            if (c[i] < c[i - 1]) {
+                std::swap(c[i], c[i - 1]);
+                sift_up<false>(i - 1);
+            } else {
+                sift_up<true>(i);
+            }
+        } else if (i > 0) {  // alone in a new node
+            if (c[i] < c[2 * parent(i / 2)])
+                sift_up<false>(i);
+            else
+                sift_up<true>(i);
+        }
+    }
+
+    void pop_min() {
+        if (c.size() > 1)
+            c.front() = std::move(c.back());
+        c.pop_back();
+        order(0);
+        sift_down_min(0);
+    }
+
+    void pop_max() {
+        if (c.size() <= 2) {
+            c.pop_back();
+            return;
+        }
+        c[1] = std::move(c.back());
+        c.pop_back();
+        order(0);
+        sift_down_max(0);
+    }
+
+    /**
+     * @brief Push @c x then pop the smallest element, returning it, with a
+     * single sift-down.
+     */
+    _Tp push_pop_min(const _Tp& x) {
+        if (c.empty() || !(c.front() < x))
+            return x;
+        _Tp out = std::move(c.front());
+        c.front() = x;
+        order(0);
+        sift_down_min(0);
+        return out;
+    }
+
+    /**
+     * @brief Push @c x then pop the largest element, returning it, with a
+     * single sift-down.
+     */
+    _Tp push_pop_max(const _Tp& x) {
+        if (c.empty() || !(x < max()))
+            return x;
+        const std::size_t top = high(0);
+        _Tp out = std::move(c[top]);
+        c[top] = x;
+        order(0);
+        sift_down_max(0);
+        return out;
+    }
+
+    void reserve(std::size_t n) { c.reserve(n); }
+
+    /**
+     * @brief Remove every element. The memory is kept.
+     */
+    void clear() { c.clear(); }
+};
+
+/**
+ * @brief Type in which @c quantile_heap_sums adds up elements: integers in
+ * 64 bits, anything else in double.
+ */
+template <typename _Tp>
+struct quantile_heap_sum_type {
+    typedef typename std::conditional<
+        std::is_integral<_Tp>::value,
+        typename std::conditional<std::is_signed<_Tp>::value,
+                                  long long,
+                                  unsigned long long>::type,
+        double>::type type;
+};
+
+/**
+ * @brief Running sums of the elements of each heap, kept by
+ * @c quantile_heap_base when @a _Enabled. This primary template keeps none
+ * and costs nothing.
+ */
+template <typename _Tp, bool _Enabled>
+class quantile_heap_sums {
+   protected:
+    typedef typename quantile_heap_sum_type<_Tp>::type sum_type;
+
+    void add_lower(const _Tp&) {}
+    void add_higher(const _Tp&) {}
+    void sub_lower(const _Tp&) {}
+    void sub_higher(const _Tp&) {}
+    void reset_sums() {}
+};
+
+template <typename _Tp>
+class quantile_heap_sums<_Tp, true> {
+   protected:
+    typedef typename quantile_heap_sum_type<_Tp>::type sum_type;
+
+    sum_type lower_sum;   // of the elements of lower_heap not erased ...
+    sum_type higher_sum;  // ... and of higher_heap.
+
+    quantile_heap_sums() : lower_sum(0), higher_sum(0) {}
+
+    void add_lower(const _Tp& x) { lower_sum += static_cast<sum_type>(x); }
+    void add_higher(const _Tp& x) { higher_sum += static_cast<sum_type>(x); }
+    void sub_lower(const _Tp& x) { lower_sum -= static_cast<sum_type>(x); }
+    void sub_higher(const _Tp& x) { higher_sum -= static_cast<sum_type>(x); }
+    void reset_sums() { lower_sum = higher_sum = 0; }
+};
+
+/**
+ * @brief Background implementation for median_heap and quantile_heap.
+ *
+ * @note Elements are split between @c lower_heap (a max-heap) and
+ * @c higher_heap (a min-heap), both @a _Arity-ary, such that no element of
+ * @c lower_heap exceeds an element of @c higher_heap. Child classes pick how
+ * many elements @c lower_heap should hold and call @c balance with it.
+ *
+ * @note Erased elements are removed lazily: they are only counted in
+ * @c lower_delayed or @c higher_delayed, and dropped once they reach the top
+ * of their heap. Sizes (and sums, with @a _Track_sums) are those of the
+ * elements still in the container, and the top of either heap is never an
+ * erased element.
+ */
+template <typename _Tp, std::size_t _Arity, bool _Track_sums = false>
+class quantile_heap_base : protected quantile_heap_sums<_Tp, _Track_sums> {
+   private:
+    typedef std::unordered_map<_Tp, std::size_t> delayed_map;
+
+    delayed_map lower_delayed;   // erased elements still in lower_heap ...
+    delayed_map higher_delayed;  // ... and in higher_heap.
+
+    /**
+     * @brief Pop erased elements off the top of a heap, and get rid of all of
+     * them once they make up more than half of it.
+     */
+    template <typename _Heap>
+    static void prune(_Heap& heap, delayed_map& delayed, std::size_t size) {
+        while (!delayed.empty() && !heap.empty()) {
+            typename delayed_map::iterator it = delayed.find(heap.top());
+            if (it == delayed.end())
+                break;
+            if (--it->second == 0)
+                delayed.erase(it);
+            heap.pop();
+        }
+        if (heap.size() > 2 * size + 64)
+            heap.compact(delayed);
+    }
+
+   protected:
+    d_ary_heap<_Tp, std::less<_Tp>, _Arity> lower_heap;
+    d_ary_heap<_Tp, std::greater<_Tp>, _Arity> higher_heap;
+
+    std::size_t lower_size;   // elements of lower_heap not erased ...
+    std::size_t higher_size;  // ... and of higher_heap.
+
+    typedef quantile_heap_sums<_Tp, _Track_sums> Sums_type;
+
+    quantile_heap_base() : lower_size(0), higher_size(0) {}
+
+    /**
+     * @brief Add @c x to the heap it belongs to, without balancing.
+     */
+    void insert(const _Tp& x) {
+        if (lower_size && !(x > lower_heap.top())) {
+            lower_heap.push(x);
+            ++lower_size;
+            Sums_type::add_lower(x);
+        } else {
+            higher_heap.push(x);
+            ++higher_size;
+            Sums_type::add_higher(x);
+        }
+    }
+
+    /**
+     * @brief Remove one occurence of @c x, which must be in the container,
+     * without balancing.
+     */
+    void remove(const _Tp& x) {
+        if (lower_size && !(x > lower_heap.top())) {
+            --lower_size;
+            Sums_type::sub_lower(x);
+            if (x == lower_heap.top())
+                lower_heap.pop();
+            else
+                ++lower_delayed[x];
+            prune(lower_heap, lower_delayed, lower_size);
+        } else {
+            --higher_size;
+            Sums_type::sub_higher(x);
+            if (x == higher_heap.top())
+                higher_heap.pop();
+            else
+                ++higher_delayed[x];
+            prune(higher_heap, higher_delayed, higher_size);
+        }
+    }
+
+    /**
+     * @brief Remove the largest element of @c lower_heap, without balancing.
+     */
+    void pop_lower() {
+        Sums_type::sub_lower(lower_heap.top());
+        lower_heap.pop();
+        --lower_size;
+        prune(lower_heap, lower_delayed, lower_size);
+    }
+
+    /**
+     * @brief Remove the smallest element of @c higher_heap, without
+     * balancing.
+     */
+    void pop_higher() {
+        Sums_type::sub_higher(higher_heap.top());
+        higher_heap.pop();
+        --higher_size;
+        prune(higher_heap, higher_delayed, higher_size);
+    }
+
+    /**
+     * @brief Move elements across until @c lower_heap holds @c target of
+     * them.
+     */
+    void balance(std::size_t target) {
+        while (lower_size < target) {
+            lower_heap.push(higher_heap.top());
+            ++lower_size;
+            Sums_type::add_lower(higher_heap.top());
+            pop_higher();
+        }
+        while (lower_size > target) {
+            higher_heap.push(lower_heap.top());
+            ++higher_size;
+            Sums_type::add_higher(lower_heap.top());
+            pop_lower();
+        }
+    }
+
+    /**
+     * @brief Remove all elements, keeping the memory of both heaps.
+     */
+    void reset() {
+        lower_heap.clear();
+        higher_heap.clear();
+        if (!lower_delayed.empty())
+            lower_delayed.clear();
+        if (!higher_delayed.empty())
+            higher_delayed.clear();
+        lower_size = higher_size = 0;
+        Sums_type::reset_sums();
+    }
+
+    /**
+     * @brief Replace all elements with @c values, the @c target smallest of
+     * them going to @c lower_heap, in @a O(n).
+     */
+    void assign(std::vector<_Tp>& values, std::size_t target) {
+        reset();
+        if (target > values.size())
+            target = values.size();
+        std::nth_element(values.begin(), values.begin() + target, values.end());
+        lower_heap.assign(values.begin(), values.begin() + target);
+        higher_heap.assign(values.begin() + target, values.end());
+        lower_size = target;
+        higher_size = values.size() - target;
+        for (std::size_t i = 0; i < target; ++i)
+            Sums_type::add_lower(values[i]);
+        for (std::size_t i = target; i < values.size(); ++i)
+            Sums_type::add_higher(values[i]);
+    }
+
+    /**
+     * @brief Reserve room for @c lower and @c higher elements in the heaps.
+     */
+    void reserve(std::size_t lower, std::size_t higher) {
+        lower_heap.reserve(lower);
+        higher_heap.reserve(higher);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_QUANTILE_HEAP_BASE */
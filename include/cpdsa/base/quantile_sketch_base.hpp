@@ -0,0 +1,159 @@
+/**
+ * CPDSA: KLL quantile sketch, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/quantile_sketch_base.hpp
+ */
+
+#ifndef CPDSA_QUANTILE_SKETCH_BASE
+#define CPDSA_QUANTILE_SKETCH_BASE
+
+#include <algorithm>  // for std::sort
+#include <cmath>      // for std::pow, std::ceil
+#include <cstddef>    // for std::size_t
+#include <cstdint>    // for std::uint64_t
+#include <vector>
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for quantile_sketch.
+ *
+ * @note A KLL sketch: a stack of compactors, where an element of level @a h
+ * stands for @a 2^h elements of the stream. Level @a h may hold about
+ * @a k * (2/3)^(H-1-h) elements (at least 2), @a H being the number of
+ * levels. Whenever the sketch holds more than all levels together may, the
+ * lowest full level is compacted: sorted, then every other element (starting
+ * from a random one of the first two) is promoted to the level above and the
+ * rest dropped.
+ */
+template <typename _Tp>
+class quantile_sketch_base {
+   private:
+    std::uint64_t state;  // xorshift64, for the compaction coin flips
+
+    bool coin() noexcept {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state & 1;
+    }
+
+    /**
+     * @brief Recompute how many elements all levels together may hold.
+     */
+    void update_limit() {
+        limit = 0;
+        for (std::size_t h = 0; h < levels.size(); ++h)
+            limit += capacity(h);
+    }
+
+    /**
+     * @brief Compact level @c h into level @c h + 1.
+     */
+    void compact(std::size_t h) {
+        if (h + 1 == levels.size()) {
+            levels.emplace_back();
+            update_limit();
+        }
+        std::vector<_Tp>& level = levels[h];
+        std::vector<_Tp>& above = levels[h + 1];
+        std::sort(level.begin(), level.end());
+        // with an odd count, the smallest element stays behind
+        const std::size_t kept = level.size() & 1;
+        for (std::size_t i = kept + coin(); i < level.size(); i += 2)
+            above.push_back(level[i]);
+        retained -= (level.size() - kept) / 2;
+        level.resize(kept);
+    }
+
+   protected:
+    std::vector<std::vector<_Tp> > levels;
+    std::size_t k;         // capacity of the top level
+    std::size_t total;     // elements seen
+    std::size_t retained;  // elements held
+    std::size_t limit;     // elements all levels together may hold
+
+    explicit quantile_sketch_base(std::size_t k_)
+        : state(0x9E3779B97F4A7C15ull),
+          levels(1),
+          k(k_ < 2 ? 2 : k_),
+          total(0),
+          retained(0),
+          limit(0) {
+        update_limit();
+    }
+
+    /**
+     * @brief Returns how many elements level @c h may hold.
+     */
+    [[nodiscard]] std::size_t capacity(std::size_t h) const {
+        const std::size_t depth = levels.size() - 1 - h;
+        const double cap = std::ceil(k * std::pow(2.0 / 3.0, depth));
+        return cap < 2 ? 2 : static_cast<std::size_t>(cap);
+    }
+
+    /**
+     * @brief Compact levels until the sketch is within its limit.
+     */
+    void compress() {
+        while (retained >= limit) {
+            std::size_t h = 0;
+            while (levels[h].size() < capacity(h))
+                ++h;
+            compact(h);
+        }
+    }
+
+    /**
+     * @brief Add an element of weight 1.
+     */
+    void insert(const _Tp& x) {
+        levels[0].push_back(x);
+        ++total;
+        if (++retained >= limit)
+            compress();
+    }
+
+    /**
+     * @brief Add every level of @c other to the matching level of this
+     * sketch.
+     */
+    void absorb(const quantile_sketch_base& other) {
+        if (levels.size() < other.levels.size())
+            levels.resize(other.levels.size());
+        for (std::size_t h = 0; h < other.levels.size(); ++h)
+            levels[h].insert(levels[h].end(), other.levels[h].begin(),
+                             other.levels[h].end());
+        total += other.total;
+        retained += other.retained;
+        update_limit();
+        compress();
+    }
+
+    /**
+     * @brief Drop every element, keeping @a k.
+     */
+    void reset() {
+        levels.assign(1, std::vector<_Tp>());
+        total = retained = 0;
+        update_limit();
+    }
+
+    /**
+     * @brief Returns every held element with its weight, sorted by value.
+     */
+    [[nodiscard]] std::vector<std::pair<_Tp, std::size_t> > weighted() const {
+        std::vector<std::pair<_Tp, std::size_t> > result;
+        result.reserve(retained);
+        for (std::size_t h = 0; h < levels.size(); ++h)
+            for (std::size_t i = 0; i < levels[h].size(); ++i)
+                result.push_back(
+                    std::make_pair(levels[h][i], std::size_t(1) << h));
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_QUANTILE_SKETCH_BASE */
@@ -7,22 +7,422 @@
 #ifndef CPDSA_SKIP_LIST_BASE
 #define CPDSA_SKIP_LIST_BASE
 
+#include <algorithm>  // for std::lower_bound, std::move
+#include <bit>        // for std::countr_zero
 #include <cstddef>
-#include <list>
+#include <cstdint>
+#include <new>          // for std::align_val_t
+#include <type_traits>  // for std::conditional_t
+#include <utility>      // for std::pair, std::swap
 
 namespace cpdsa {
 
 /**
  * @brief Background implementation for skip_list.
  *
- * @note Todo after first-working-iteration: contiguous blocks _Tp[] totaling 64 bytes.
+ * @note A skip list over blocks rather than single elements. Each block holds
+ * up to @c BLOCK_SIZE sorted elements (@c BLOCK_BYTES worth of them) and is
+ * linked into the lowest @c height levels, ordered by its first element.
+ * Blocks are aligned to cache lines and span several of them, so the levels
+ * only index one block in @c BLOCK_SIZE elements and the final binary search
+ * runs over contiguous memory.
+ *
+ * @note For small elements, every link also holds a copy of the first element
+ * of the block it points to, so that deciding whether to follow it reads
+ * nothing but the current block: a lookup only touches the blocks it
+ * actually goes through, then searches one block of elements.
+ *
+ * @note Blocks are split in half when full, and merged with the next one
+ * when both fit in half a block.
+ *
+ * @note Every link also records its width: how many elements lie from the
+ * start of its block to the start of the block it points to (to the end of
+ * the list for a null link). Adding up widths along a descent gives ranks,
+ * so that rank and select queries take one descent as well. Widths are
+ * 32-bit, like the counts of @c ordered_set.
  */
 template <typename _Tp, std::size_t _Levels = 16>
 class skip_list_base {
-   private:
-    std::list<_Tp> levels[_Levels];
-
    protected:
+    static_assert(_Levels >= 1 && _Levels <= 32, "between 1 and 32 levels");
+
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    struct block;
+
+    /**
+     * @brief Whether links keep a copy of the first element of their target.
+     * Only worth it for small elements that are cheap to copy.
+     */
+    static constexpr bool CACHE_FIRST =
+        std::is_trivially_copyable_v<_Tp> && sizeof(_Tp) <= sizeof(void*);
+
+    struct uncached {};
+
+    /**
+     * @brief A forward pointer, with the number of elements it skips over
+     * and (with @c CACHE_FIRST) the first element of its target.
+     */
+    struct link {
+        block* to;
+        std::uint32_t width;
+        [[no_unique_address]] std::conditional_t<CACHE_FIRST, _Tp, uncached>
+            first;
+    };
+
+    static const _Tp& first_of(const link& l) noexcept {
+        if constexpr (CACHE_FIRST)
+            return l.first;
+        else
+            return l.to->keys[0];
+    }
+
+    static void set_first(link& l, const _Tp& x) noexcept {
+        if constexpr (CACHE_FIRST)
+            l.first = x;
+    }
+
+    /**
+     * @brief Bytes of elements per block: 128 ints. Lookups keep getting
+     * faster up to about this size, as the levels above thin out; past it,
+     * shifting elements on insert and erase starts to cost more.
+     */
+    static constexpr std::size_t BLOCK_BYTES = 512;
+
+    /**
+     * @brief Maximum number of elements per block, so that large elements
+     * get proportionally fewer (but at least two, to split in half).
+     */
+    static constexpr std::uint32_t BLOCK_SIZE =
+        sizeof(_Tp) * 2 > BLOCK_BYTES ? 2 : BLOCK_BYTES / sizeof(_Tp);
+
+    /**
+     * @brief A run of consecutive elements, followed in memory by its
+     * @c height links.
+     */
+    struct block {
+        block* prev;  // on level 0
+        std::uint32_t count;
+        std::uint32_t height;
+        _Tp keys[BLOCK_SIZE];
+
+        link* links() noexcept { return reinterpret_cast<link*>(this + 1); }
+        const link* links() const noexcept {
+            return reinterpret_cast<const link*>(this + 1);
+        }
+        block* next() const noexcept { return links()[0].to; }
+    };
+
+    block* head;        // sentinel of height _Levels, holding no element
+    block* tail;        // last block, or head
+    std::size_t level;  // height of the tallest block
+    std::size_t total;  // number of elements
+
+    /**
+     * @brief Returns a height with @a P(h) = 2^-h, from a per-thread
+     * xorshift generator.
+     */
+    static std::uint32_t random_height() noexcept {
+        thread_local std::uint64_t state = 0x9E3779B97F4A7C15ull;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return 1 + std::countr_zero(state | (1ull << (_Levels - 1)));
+    }
+
+    static std::size_t block_bytes(std::uint32_t height) noexcept {
+        return sizeof(block) + height * sizeof(link);
+    }
+
+    static block* create(std::uint32_t height) {
+        void* memory = ::operator new(block_bytes(height),
+                                      std::align_val_t(CACHE_LINE));
+        block* b = new (memory) block;
+        b->prev = nullptr;
+        b->count = 0;
+        b->height = height;
+        for (std::uint32_t i = 0; i < height; ++i)
+            new (b->links() + i) link{nullptr, 0, {}};
+        return b;
+    }
+
+    static void destroy(block* b) noexcept {
+        for (std::uint32_t i = 0; i < b->height; ++i)
+            b->links()[i].~link();
+        b->~block();
+        ::operator delete(b, std::align_val_t(CACHE_LINE));
+    }
+
+    /**
+     * @brief Returns the last block whose first element is less than (with
+     * @a _Strict) or not greater than @c x, or @c head. With @c update, also
+     * stores that block's counterpart on every level, and with @c ranks the
+     * number of elements before each of those.
+     */
+    template <bool _Strict>
+    block* descend(const _Tp& x,
+                   block** update,
+                   std::size_t* ranks = nullptr) const {
+        block* b = head;
+        std::size_t rank = 0;
+        for (std::size_t i = _Levels; i-- > 0;) {
+            if (i < level) {
+                for (const link* l = b->links() + i;
+                     l->to &&
+                     (_Strict ? first_of(*l) < x : !(x < first_of(*l)));
+                     l = b->links() + i) {
+                    rank += l->width;
+                    b = l->to;
+                }
+            }
+            if (update)
+                update[i] = b;
+            if (ranks)
+                ranks[i] = rank;
+        }
+        return b;
+    }
+
+    /**
+     * @brief Link @c b, whose first element must be set and which has
+     * @c rank elements before it, in after the blocks in @c update, which
+     * have @c ranks elements before them. The widths of the links of
+     * @c update must already count the elements of @c b.
+     */
+    void attach(block* b,
+                block* const* update,
+                const std::size_t* ranks,
+                std::size_t rank) {
+        for (std::uint32_t i = 0; i < b->height; ++i) {
+            link& pred = update[i]->links()[i];
+            const std::uint32_t span = rank - ranks[i];
+            b->links()[i] = pred;
+            b->links()[i].width -= span;
+            pred.to = b;
+            pred.width = span;
+            set_first(pred, b->keys[0]);
+        }
+        b->prev = update[0];
+        if (b->next())
+            b->next()->prev = b;
+        else
+            tail = b;
+        if (level < b->height)
+            level = b->height;
+    }
+
+    /**
+     * @brief Unlink @c b, preceded on every level by the blocks in
+     * @c update, and free it.
+     */
+    void detach(block* b, block* const* update) {
+        for (std::uint32_t i = 0; i < b->height; ++i) {
+            link& pred = update[i]->links()[i];
+            const std::uint32_t width = pred.width + b->links()[i].width;
+            pred = b->links()[i];
+            pred.width = width;
+        }
+        if (b->next())
+            b->next()->prev = b->prev;
+        else
+            tail = b->prev;
+        destroy(b);
+        while (level > 1 && !head->links()[level - 1].to)
+            --level;
+    }
+
+    skip_list_base()
+        : head(create(_Levels)), tail(head), level(1), total(0) {}
+
+    skip_list_base(skip_list_base&& other) noexcept : skip_list_base() {
+        swap(other);
+    }
+
+    skip_list_base& operator=(skip_list_base&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    skip_list_base(const skip_list_base&) = delete;
+    skip_list_base& operator=(const skip_list_base&) = delete;
+
+    ~skip_list_base() {
+        reset();
+        destroy(head);
+    }
+
+    void swap(skip_list_base& other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(level, other.level);
+        std::swap(total, other.total);
+    }
+
+    /**
+     * @brief Returns the block and position of the first element not less
+     * than (or, with @a _Upper, greater than) @c x; a null block if none.
+     */
+    template <bool _Upper>
+    std::pair<block*, std::uint32_t> locate(const _Tp& x) const {
+        block* b = descend<false>(x, nullptr);
+        if (b == head)
+            return {head->next(), 0};
+        const _Tp* keys = b->keys;
+        std::uint32_t i = (_Upper ? std::upper_bound(keys, keys + b->count, x)
+                                  : std::lower_bound(keys, keys + b->count, x)) -
+                          keys;
+        if (i == b->count)
+            return {b->next(), 0};
+        return {b, i};
+    }
+
+    /**
+     * @brief Insert @c x at position @c i of @c b, which must not be full.
+     */
+    static void place(block* b, std::uint32_t i, const _Tp& x) {
+        std::move_backward(b->keys + i, b->keys + b->count,
+                           b->keys + b->count + 1);
+        b->keys[i] = x;
+        ++b->count;
+    }
+
+    /**
+     * @brief Add @c x unless it is already there.
+     */
+    bool insert(const _Tp& x) {
+        block* update[_Levels];
+        std::size_t ranks[_Levels];
+        block* b = descend<false>(x, update, ranks);
+        std::uint32_t i = 0;
+        const bool smallest = b == head;
+        if (!smallest) {
+            i = std::lower_bound(b->keys, b->keys + b->count, x) - b->keys;
+            if (i < b->count && b->keys[i] == x)
+                return false;
+        } else if (!(b = head->next())) {
+            for (std::size_t j = 0; j < _Levels; ++j)
+                head->links()[j].width = 1;
+            b = create(random_height());
+            b->keys[0] = x;
+            b->count = 1;
+            attach(b, update, ranks, 0);
+            ++total;
+            return true;
+        }
+        // from now on update holds the blocks whose links span x
+        const std::size_t rank = smallest ? 0 : ranks[0];
+        for (std::uint32_t j = 0; j < b->height; ++j) {
+            update[j] = b;
+            ranks[j] = rank;
+        }
+        for (std::size_t j = 0; j < _Levels; ++j)
+            ++update[j]->links()[j].width;
+        if (b->count < BLOCK_SIZE) {
+            place(b, i, x);
+        } else {
+            block* n = create(random_height());
+            const std::uint32_t half = BLOCK_SIZE / 2;
+            std::move(b->keys + half, b->keys + BLOCK_SIZE, n->keys);
+            n->count = BLOCK_SIZE - half;
+            b->count = half;
+            if (i > half)
+                place(n, i - half, x);
+            else
+                place(b, i, x);
+            attach(n, update, ranks, rank + b->count);
+        }
+        ++total;
+        if (smallest)  // the first block starts with x now
+            for (std::uint32_t j = 0; j < b->height; ++j)
+                set_first(head->links()[j], x);
+        return true;
+    }
+
+    /**
+     * @brief Remove @c x if it is there.
+     */
+    bool erase(const _Tp& x) {
+        block* update[_Levels];
+        block* b = descend<true>(x, update);
+        std::uint32_t i = 0;
+        if (b->next() && first_of(b->links()[0]) == x) {
+            b = b->next();
+        } else {
+            if (b == head)
+                return false;
+            i = std::lower_bound(b->keys, b->keys + b->count, x) - b->keys;
+            if (i == b->count || !(b->keys[i] == x))
+                return false;
+        }
+        for (std::size_t j = 0; j < _Levels; ++j)
+            --(j < b->height ? b : update[j])->links()[j].width;
+        std::move(b->keys + i + 1, b->keys + b->count, b->keys + i);
+        --b->count;
+        --total;
+        if (!i) {  // then x was first, and update holds b's neighbours
+            if (!b->count) {
+                detach(b, update);
+                return true;
+            }
+            for (std::uint32_t j = 0; j < b->height; ++j)
+                set_first(update[j]->links()[j], b->keys[0]);
+        }
+        block* n = b->next();
+        if (n && b->count + n->count <= BLOCK_SIZE / 2) {
+            for (std::uint32_t j = 0; j < b->height; ++j)
+                update[j] = b;
+            std::move(n->keys, n->keys + n->count, b->keys + b->count);
+            b->count += n->count;
+            detach(n, update);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of elements not greater than @c x.
+     */
+    std::size_t rank_of(const _Tp& x) const {
+        std::size_t ranks[_Levels];
+        const block* b = descend<false>(x, nullptr, ranks);
+        if (b == head)
+            return 0;
+        return ranks[0] +
+               (std::upper_bound(b->keys, b->keys + b->count, x) - b->keys);
+    }
+
+    /**
+     * @brief Returns the block and position of the @c k-th (1-based)
+     * smallest element; a null block if there are fewer than @c k.
+     */
+    std::pair<block*, std::uint32_t> select(std::size_t k) const {
+        if (!k || k > total)
+            return {nullptr, 0};
+        block* b = head;
+        std::size_t rank = 0;  // elements before b
+        for (std::size_t i = level; i-- > 0;)
+            for (const link* l = b->links() + i;
+                 l->to && rank + l->width < k; l = b->links() + i) {
+                rank += l->width;
+                b = l->to;
+            }
+        return {b, static_cast<std::uint32_t>(k - rank - 1)};
+    }
+
+    /**
+     * @brief Free every block.
+     */
+    void reset() noexcept {
+        for (block* b = head->next(); b;) {
+            block* n = b->next();
+            destroy(b);
+            b = n;
+        }
+        for (std::size_t i = 0; i < _Levels; ++i)
+            head->links()[i] = link{nullptr, 0, {}};
+        tail = head;
+        level = 1;
+        total = 0;
+    }
 };
 
 }  // namespace cpdsa
@@ -0,0 +1,143 @@
+/**
+ * CPDSA: Single-pattern string search, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/string_search_base.hpp
+ */
+
+#ifndef CPDSA_STRING_SEARCH_BASE
+#define CPDSA_STRING_SEARCH_BASE
+
+#include <bit>  // for std::countr_zero
+#include <cstddef>
+#include <cstdint>  // for std::uint32_t
+#include <cstring>  // for std::memcmp
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for string_search.
+ *
+ * @note Candidates are found @c WIDTH positions at a time, by comparing one
+ * vector of the text with the first byte of the pattern and the vector
+ * @a m - 1 bytes further with its last byte: both must match, which in most
+ * texts rules out nearly every position with two loads and three
+ * instructions. The rest of the pattern is then checked with @c memcmp.
+ *
+ * @note Checks cost up to @a m each, so a text where most candidates fail
+ * late (e.g. "aaaa..." for "a...aba") would take @a O(nm). Once they have
+ * compared more than twice the bytes scanned, the search goes on with the
+ * Knuth-Morris-Pratt automaton instead, which keeps every search in
+ * @a O(n + m). It also handles the last positions, where a whole vector no
+ * longer fits.
+ */
+class string_search_base {
+   protected:
+    using size_type = std::size_t;
+
+#if defined(__AVX2__)
+    static constexpr size_type WIDTH = 32;
+#elif defined(__SSE2__)
+    static constexpr size_type WIDTH = 16;
+#else
+    static constexpr size_type WIDTH = 1;
+#endif
+
+    std::string pattern;
+    // prefix[i]: length of the longest proper border of pattern[0, i]
+    std::vector<std::uint32_t> prefix;
+
+    void build(std::string_view pattern_) {
+        pattern = pattern_;
+        prefix.assign(pattern.size(), 0);
+        for (size_type i = 1, k = 0; i < pattern.size(); ++i) {
+            while (k && pattern[i] != pattern[k])
+                k = prefix[k - 1];
+            if (pattern[i] == pattern[k])
+                ++k;
+            prefix[i] = k;
+        }
+    }
+
+    /**
+     * @brief Returns a mask of the positions @c text[i] among the next
+     * @c WIDTH where the first and last bytes of the pattern match.
+     */
+    [[nodiscard]] std::uint32_t candidates(const char* text) const noexcept {
+        const size_type m = pattern.size();
+#if defined(__AVX2__)
+        const __m256i first = _mm256_set1_epi8(pattern[0]);
+        const __m256i last = _mm256_set1_epi8(pattern[m - 1]);
+        const __m256i a = _mm256_loadu_si256((const __m256i*)text);
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(text + m - 1));
+        return _mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+#elif defined(__SSE2__)
+        const __m128i first = _mm_set1_epi8(pattern[0]);
+        const __m128i last = _mm_set1_epi8(pattern[m - 1]);
+        const __m128i a = _mm_loadu_si128((const __m128i*)text);
+        const __m128i b = _mm_loadu_si128((const __m128i*)(text + m - 1));
+        return _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+#else
+        return text[0] == pattern[0] && text[m - 1] == pattern[m - 1];
+#endif
+    }
+
+    /**
+     * @brief Call @c report(i) for every occurrence @c text[i, i + m) with
+     * @c i >= @c from, in order, until it returns true.
+     *
+     * @return The position for which @c report returned true, or
+     * @c std::string_view::npos.
+     */
+    template <typename _Report>
+    size_type search(std::string_view text, size_type from,
+                     _Report&& report) const {
+        const size_type m = pattern.size(), n = text.size();
+        if (m == 0) {
+            for (size_type i = from; i <= n; ++i)
+                if (report(i))
+                    return i;
+            return std::string_view::npos;
+        }
+        if (n < m || from > n - m)
+            return std::string_view::npos;
+        const char* data = text.data();
+        size_type i = from, checked = 0;
+        // one vector of candidates at a time
+        for (; i + m - 1 + WIDTH <= n && checked <= 2 * (i - from); i += WIDTH)
+            for (std::uint32_t mask = candidates(data + i); mask;
+                 mask &= mask - 1) {
+                const size_type at = i + std::countr_zero(mask);
+                if (m > 2) {
+                    checked += m;
+                    if (std::memcmp(data + at + 1, pattern.data() + 1, m - 2))
+                        continue;
+                }
+                if (report(at))
+                    return at;
+            }
+        // then the automaton
+        for (size_type k = 0; i < n; ++i) {
+            while (k && data[i] != pattern[k])
+                k = prefix[k - 1];
+            if (data[i] == pattern[k] && ++k == m) {
+                if (report(i + 1 - m))
+                    return i + 1 - m;
+                k = prefix[k - 1];
+            }
+        }
+        return std::string_view::npos;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_STRING_SEARCH_BASE */
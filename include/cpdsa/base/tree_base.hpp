@@ -0,0 +1,107 @@
+/**
+ * CPDSA: Rooted tree, base implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/base/tree_base.hpp
+ */
+
+#ifndef CPDSA_TREE_BASE
+#define CPDSA_TREE_BASE
+
+#include <algorithm>  // for std::min
+#include <bit>        // for std::bit_width
+#include <cstddef>
+#include <utility>    // for std::move
+#include <vector>
+
+#include "../csr_graph.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief Background implementation for tree.
+ *
+ * @note The tree is flattened by an iterative depth-first search into arrays
+ * indexed by vertex (@a parents, @a depths, @a positions, @a sizes) and its
+ * preorder @a order, in which the subtree of @a v is the range
+ * @a [positions[v], positions[v] + sizes[v]).
+ *
+ * @note Let @a p = @a positions. The lowest common ancestor of @a u != @a v,
+ * with @a p[u] < @a p[v], is the parent of the shallowest vertex in
+ * @a order(p[u], p[v]]: every vertex there is in the subtree of the LCA but
+ * not the LCA itself, and the child of the LCA towards @a v is one of them.
+ * So the LCA is @a order[m], where @a m is the minimum of
+ * @a p[parents[order[i]]] over that range. Unlike the classic Euler tour of
+ * @a 2n - 1 entries, this needs only @a n, and a query takes the minimum of
+ * two entries of a sparse table over them, with no depth comparisons.
+ */
+class tree_base {
+   protected:
+    using vertex_type = csr_graph<>::vertex_type;
+    using size_type = std::size_t;
+
+    static constexpr vertex_type NONE = csr_graph<>::UNREACHED;
+
+    vertex_type root_vertex = 0;
+    std::vector<vertex_type> parents, depths, positions, sizes, order;
+    // table[k][i] is the minimum of table[0][i, i + 2^k)
+    std::vector<std::vector<vertex_type>> table;
+
+    /**
+     * @brief Flatten the tree with root @c root whose arcs, apart from
+     * those to a vertex's parent, are in @c graph. Takes @a O(n log(n)).
+     */
+    void build(const csr_graph<>& graph, vertex_type root) {
+        const size_type n = graph.vertex_count();
+        root_vertex = root;
+        parents.assign(n, NONE);
+        depths.assign(n, 0);
+        positions.assign(n, 0);
+        sizes.assign(n, 1);
+        order.clear();
+        order.reserve(n);
+        std::vector<vertex_type> stack = {root};
+        while (!stack.empty()) {
+            const vertex_type v = stack.back();
+            stack.pop_back();
+            positions[v] = order.size();
+            order.push_back(v);
+            // pushed backwards, so that children are visited in order
+            const auto neighbors = graph.neighbors(v);
+            for (size_type i = neighbors.size(); i--;) {
+                const vertex_type u = neighbors[i];
+                if (u == parents[v])
+                    continue;
+                parents[u] = v;
+                depths[u] = depths[v] + 1;
+                stack.push_back(u);
+            }
+        }
+        for (size_type i = order.size(); i-- > 1;)
+            sizes[parents[order[i]]] += sizes[order[i]];
+
+        table.assign(1, std::vector<vertex_type>(order.size()));
+        for (size_type i = 1; i < order.size(); ++i)
+            table[0][i] = positions[parents[order[i]]];
+        for (size_type k = 1; (size_type(1) << k) < order.size(); ++k) {
+            const std::vector<vertex_type>& prev = table[k - 1];
+            const size_type half = size_type(1) << (k - 1);
+            std::vector<vertex_type> row(prev.size() - half);
+            for (size_type i = 0; i < row.size(); ++i)
+                row[i] = std::min(prev[i], prev[i + half]);
+            table.push_back(std::move(row));
+        }
+    }
+
+    /**
+     * @brief Returns the position in @c order of the LCA of the vertices at
+     * positions @c l < @c r.
+     */
+    vertex_type lca_position(size_type l, size_type r) const noexcept {
+        const size_type k = std::bit_width(r - l) - 1;
+        return std::min(table[k][l + 1], table[k][r + 1 - (size_type(1) << k)]);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_TREE_BASE */
@@ -0,0 +1,217 @@
+/**
+ * CPDSA: Arbitrary-precision integer -*- C++ -*-
+ *
+ * @file include/cpdsa/src/bigint.hpp
+ */
+
+#ifndef CPDSA_BIGINT
+#define CPDSA_BIGINT
+
+#include <cctype>  // for isdigit
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>  // for std::is_signed_v
+#include <utility>      // for std::move
+
+#include "base/bigint_base.hpp"
+#include "buffer_scan.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief A signed integer of any size.
+ *
+ * @note Multiplying two numbers of @a n limbs (about @a 19.3n digits) takes
+ * @a O(n^2) below 32 limbs, @a O(n^1.58) below 4096 limbs and
+ * @a O(n log(n)) beyond that. Division costs a few multiplications, and
+ * converting @a n digits to or from decimal @a O(log(n)) of them (see
+ * @c bigint_base).
+ *
+ * @note Division truncates towards zero and the remainder has the sign of the
+ * dividend, as for built-in integers. Dividing by zero is undefined.
+ */
+class bigint : private bigint_base {
+   private:
+    using Base_type = bigint_base;
+
+    void normalize() noexcept {
+        if (mag.empty())
+            negative = false;
+    }
+
+    /**
+     * @brief Adds @c other, negated if @c flip is set.
+     */
+    bigint& add_signed(const bigint& other, bool flip) {
+        if (negative == (other.negative != flip)) {
+            Base_type::add(mag, other.mag);
+        } else if (Base_type::compare(mag, other.mag) >= 0) {
+            Base_type::sub(mag, other.mag);
+        } else {
+            limbs result = other.mag;
+            Base_type::sub(result, mag);
+            mag = std::move(result);
+            negative = !negative;
+        }
+        normalize();
+        return *this;
+    }
+
+   public:
+    using size_type = std::size_t;
+
+    /**
+     * @brief Create a bigint equal to 0.
+     */
+    bigint() = default;
+
+    /**
+     * @brief Create a bigint equal to @c val.
+     */
+    template <std::integral _Int>
+    bigint(_Int val) {
+        unsigned long long magnitude = val;
+        if constexpr (std::is_signed_v<_Int>) {
+            if (val < 0) {
+                negative = true;
+                magnitude = -magnitude;
+            }
+        }
+        if (magnitude)
+            mag.push_back(magnitude);
+    }
+
+    /**
+     * @brief Create a bigint from its decimal digits, optionally preceded by
+     * a sign.
+     */
+    explicit bigint(std::string_view digits) {
+        bool sign = false;
+        if (!digits.empty() && (digits[0] == '-' || digits[0] == '+')) {
+            sign = digits[0] == '-';
+            digits.remove_prefix(1);
+        }
+        mag = Base_type::from_decimal(digits.data(), digits.size());
+        negative = sign && !mag.empty();
+    }
+
+    /**
+     * @brief Returns the decimal representation of the number.
+     */
+    [[nodiscard]] std::string to_string() const {
+        if (mag.empty())
+            return "0";
+        std::string result = Base_type::to_decimal(mag);
+        if (negative)
+            result.insert(result.begin(), '-');
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of 64-bit limbs of the absolute value.
+     */
+    [[nodiscard]] size_type size() const noexcept { return mag.size(); }
+
+    explicit operator bool() const noexcept { return !mag.empty(); }
+
+    [[nodiscard]] bigint operator-() const {
+        bigint result = *this;
+        result.negative = !negative && !mag.empty();
+        return result;
+    }
+
+    bigint& operator+=(const bigint& other) { return add_signed(other, false); }
+    bigint& operator-=(const bigint& other) { return add_signed(other, true); }
+
+    bigint& operator*=(const bigint& other) {
+        mag = Base_type::multiply(mag, other.mag);
+        negative = negative != other.negative;
+        normalize();
+        return *this;
+    }
+
+    bigint& operator/=(const bigint& other) {
+        limbs q, r;
+        Base_type::divmod(mag, other.mag, q, r);
+        mag = std::move(q);
+        negative = negative != other.negative;
+        normalize();
+        return *this;
+    }
+
+    bigint& operator%=(const bigint& other) {
+        limbs q, r;
+        Base_type::divmod(mag, other.mag, q, r);
+        mag = std::move(r);
+        normalize();
+        return *this;
+    }
+
+    friend bigint operator+(bigint a, const bigint& b) { return a += b; }
+    friend bigint operator-(bigint a, const bigint& b) { return a -= b; }
+    friend bigint operator*(const bigint& a, const bigint& b) {
+        bigint result;
+        result.mag = Base_type::multiply(a.mag, b.mag);
+        result.negative = a.negative != b.negative && !result.mag.empty();
+        return result;
+    }
+    friend bigint operator/(bigint a, const bigint& b) { return a /= b; }
+    friend bigint operator%(bigint a, const bigint& b) { return a %= b; }
+
+    [[nodiscard]] bool operator==(const bigint& other) const noexcept {
+        return negative == other.negative && mag == other.mag;
+    }
+
+    [[nodiscard]] std::strong_ordering operator<=>(
+        const bigint& other) const noexcept {
+        if (negative != other.negative)
+            return negative ? std::strong_ordering::less
+                            : std::strong_ordering::greater;
+        const int c = Base_type::compare(mag, other.mag);
+        return (negative ? -c : c) <=> 0;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const bigint& x) {
+        return os << x.to_string();
+    }
+
+    friend std::istream& operator>>(std::istream& is, bigint& x) {
+        std::string digits;
+        if (is >> digits)
+            x = bigint(digits);
+        return is;
+    }
+};
+
+/**
+ * @brief Overload of @c buffer_scan for @c bigint: skips characters until a
+ * digit or @a -, then reads every digit that follows. Other arguments may be
+ * integral types or bigints.
+ */
+template <typename... _Tps>
+void buffer_scan(bigint& first_arg, _Tps&... rest_args) {
+    bool is_negative = false;
+    int next_char = 0;
+    while (!isdigit(next_char = __getc()) && next_char != '-') {
+        if (next_char == EOF)
+            break;
+    }
+    if (next_char == '-')
+        is_negative = true, next_char = __getc();
+    std::string digits;
+    for (; isdigit(next_char); next_char = __getc())
+        digits.push_back(next_char);
+    first_arg = bigint(digits);
+    if (is_negative)
+        first_arg = -first_arg;
+    buffer_scan(rest_args...);
+}
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_BIGINT */
@@ -0,0 +1,180 @@
+/**
+ * CPDSA: Leaf-bucketed ordered set -*- C++ -*-
+ *
+ * @file include/cpdsa/src/bucketed_ordered_set.hpp
+ */
+
+#ifndef CPDSA_BUCKETED_ORDERED_SET
+#define CPDSA_BUCKETED_ORDERED_SET
+
+#include <limits>
+
+#include "base/bucketed_ordered_set_base.hpp"
+
+namespace cpdsa {
+/**
+ * @brief An @c ordered_set whose sparse subtrees are stored as small sorted
+ * blocks.
+ *
+ * @tparam _Tp Type of element. Must be discrete (i.e. @c std::integral<_Tp>
+ * must holds true).
+ * @tparam LB The smallest value allowed to be added.
+ * @tparam RB One past the largest value allowed to be added.
+ * @tparam _Bucket The most elements a block holds. Defaults to one cache line.
+ *
+ * @note A subtree holding at most @a _Bucket elements is a single node with a
+ * sorted array, scanned linearly. For @a n elements spread over a wide
+ * universe this replaces the last @a log(_Bucket) levels of pointer chasing,
+ * and the long single-child chains leading to them, with one contiguous
+ * block: roughly @a n / @a _Bucket * @a log(X) nodes instead of
+ * @a n * @a log(X). Updates are still @a O(log(X) + _Bucket).
+ */
+template <std::integral _Tp,
+          _Tp LB = std::numeric_limits<_Tp>::min(),
+          _Tp RB = std::numeric_limits<_Tp>::max(),
+          size_t _Bucket = 64 / sizeof(_Tp)>
+class bucketed_ordered_set
+    : private bucketed_ordered_set_base<_Tp, LB, RB, _Bucket> {
+   private:
+    using Base_type = bucketed_ordered_set_base<_Tp, LB, RB, _Bucket>;
+
+   public:
+    /**
+     * @brief Type used for sums of elements, wide enough not to overflow.
+     */
+    using sum_type = ordered_set_sum_type<_Tp>;
+
+    /**
+     * @brief Create a bucketed_ordered_set with no elements.
+     */
+    bucketed_ordered_set() = default;
+
+    /**
+     * @brief Returns one past the largest number allowed to be added.
+     */
+    [[nodiscard]] constexpr _Tp end() const noexcept { return RB; }
+
+    /**
+     * @brief Returns the number of elements in the container.
+     */
+    [[nodiscard]] size_t size() const noexcept { return this->root.cnt; }
+
+    /**
+     * @brief Returns true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return !size(); }
+
+    /**
+     * @brief Add a new element into the container.
+     *
+     * @param val Value to be added.
+     */
+    void insert(const _Tp& val) {
+        Base_type::update(this->root, LB, RB, val,
+                          Base_type::NODE_UPDATE_ACTIONS::ADD_ONCE);
+    }
+
+    /**
+     * @brief Remove one occurence of `val` from the container.
+     *
+     * @param val Value to be removed.
+     */
+    void erase_once(const _Tp& val) {
+        Base_type::update(this->root, LB, RB, val,
+                          Base_type::NODE_UPDATE_ACTIONS::REMOVE_ONCE);
+    }
+
+    /**
+     * @brief Remove all occurences of `val` from the container.
+     *
+     * @param val Value to be removed.
+     */
+    void erase_all(const _Tp& val) {
+        Base_type::update(this->root, LB, RB, val,
+                          Base_type::NODE_UPDATE_ACTIONS::REMOVE_ALL);
+    }
+
+    /**
+     * @brief Remove all elements from the container.
+     */
+    void clear() { this->reset(); }
+
+    /**
+     * @brief Returns the number of tree nodes currently allocated, blocks
+     * included.
+     *
+     * @note Walks the whole tree, so this takes time linear in its result.
+     */
+    [[nodiscard]] size_t node_count() const noexcept {
+        size_t blocks = 0;
+        return Base_type::count_nodes(this->root, blocks);
+    }
+
+    /**
+     * @brief Returns the number of bytes held by the container.
+     *
+     * @note Same cost as @c node_count.
+     */
+    [[nodiscard]] size_t memory_usage() const noexcept {
+        size_t blocks = 0;
+        size_t nodes = Base_type::count_nodes(this->root, blocks);
+        return sizeof(*this) + (nodes - 1) * Base_type::node_size() +
+               blocks * Base_type::block_size();
+    }
+
+    /**
+     * @brief Returns the number of elements in the range `[l,r]`.
+     */
+    [[nodiscard]] int count(_Tp l, _Tp r) const noexcept {
+        return Base_type::get(this->root, LB, RB, l, r);
+    }
+
+    /**
+     * @brief Returns the sum of the elements in the range `[l,r]`.
+     */
+    [[nodiscard]] sum_type sum(_Tp l, _Tp r) const noexcept {
+        return Base_type::range_sum(this->root, LB, RB, l, r);
+    }
+
+    /**
+     * @brief Returns the number of elements less than or equal to @c val.
+     */
+    [[nodiscard]] int order_of_key(const _Tp& val) const noexcept {
+        return Base_type::get(this->root, LB, RB, LB, val);
+    }
+
+    /**
+     * @brief Returns the k-th (1-based) smallest element in the container.
+     *
+     * @param k The position of the element to find.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp find_by_order(const size_t& k) const noexcept {
+        if (k && size() >= k)
+            return Base_type::k_largest(this->root, LB, RB, k);
+        else
+            return RB;
+    }
+
+    /**
+     * @brief Returns the smallest value in the container no less than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp lower_bound(const _Tp& val) const noexcept {
+        return Base_type::lower_bound(this->root, LB, RB, val);
+    }
+
+    /**
+     * @brief Returns the largest value in the container no more than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp upper_bound(const _Tp& val) const noexcept {
+        return Base_type::upper_bound(this->root, LB, RB, val);
+    }
+};
+}  // namespace cpdsa
+
+#endif /* CPDSA_BUCKETED_ORDERED_SET */
@@ -30,9 +30,12 @@ namespace cpdsa {
  * reader in the entire program. @e Know what you are doing. Also note that this
  * function bundles a static array of @a 65536 chars. Embedded devices may not
  * like this.
+ *
+ * @note Each argument is checked by the overload reading it, so the rest may
+ * also be @c bigint (see bigint.hpp).
  */
 #if __cplusplus >= 202002L
-template <std::integral _Tp, std::integral... _Tps>
+template <std::integral _Tp, typename... _Tps>
 #else
 template <typename _Tp, typename... _Tps>
 #endif
@@ -0,0 +1,291 @@
+/**
+ * CPDSA: Sharded concurrent ordered set -*- C++ -*-
+ *
+ * @file include/cpdsa/src/concurrent_ordered_set.hpp
+ */
+
+#ifndef CPDSA_CONCURRENT_ORDERED_SET
+#define CPDSA_CONCURRENT_ORDERED_SET
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+#include "base/ordered_set_base.hpp"
+
+namespace cpdsa {
+/**
+ * @brief An @c ordered_set which can be updated and queried from several
+ * threads at once.
+ *
+ * @tparam _Tp Type of element. Must be discrete (i.e. @c std::integral<_Tp>
+ * must holds true).
+ * @tparam LB The smallest value allowed to be added.
+ * @tparam RB One past the largest value allowed to be added.
+ * @tparam _Shards The number of independently locked subtrees.
+ *
+ * @note The universe `[LB, RB]` is cut into @a _Shards equal slices, each
+ * being its own dynamic segment tree behind its own reader-writer lock, so
+ * writers only contend when they hit the same slice. Rank queries add up the
+ * (atomic) sizes of the slices before the one they end in.
+ *
+ * @note Every operation is atomic with respect to the slices it locks, but
+ * queries spanning several slices are not linearizable against concurrent
+ * writers: each slice is observed at a slightly different moment.
+ */
+template <std::integral _Tp,
+          _Tp LB = std::numeric_limits<_Tp>::min(),
+          _Tp RB = std::numeric_limits<_Tp>::max(),
+          size_t _Shards = 64>
+class concurrent_ordered_set {
+   private:
+    static_assert(_Shards > 0, "there must be at least one shard");
+
+    using Base_type = ordered_set_base<_Tp, LB, RB>;
+    using unsigned_type = std::make_unsigned_t<_Tp>;
+
+    static constexpr unsigned_type WIDTH = static_cast<unsigned_type>(
+        static_cast<unsigned_type>(RB) - static_cast<unsigned_type>(LB));
+
+    /**
+     * @brief The width of every slice but (possibly) the last one.
+     */
+    static constexpr unsigned_type SHARD_SPAN = WIDTH / _Shards + 1;
+
+    /**
+     * @brief One slice of the universe. Padded to its own cache line so that
+     * neighbouring locks don't false-share.
+     */
+    struct alignas(64) shard : private Base_type {
+        using Base_type::NODE_UPDATE_ACTIONS;
+
+        mutable std::shared_mutex mutex;
+        std::atomic<size_t> size{0};
+        _Tp lo, hi;  // the slice is [lo, hi]
+
+        void update(const _Tp& val, int action) {
+            Base_type::update(this->root, lo, hi, val, action);
+            size.store(this->root.cnt, std::memory_order_release);
+        }
+
+        void reset() {
+            Base_type::reset();
+            size.store(0, std::memory_order_release);
+        }
+
+        [[nodiscard]] int get(_Tp u, _Tp v) const {
+            return Base_type::get(this->root, lo, hi, u, v);
+        }
+
+        [[nodiscard]] _Tp k_largest(size_t k) const {
+            return this->root.cnt >= static_cast<int>(k)
+                       ? Base_type::k_largest(this->root, lo, hi, k)
+                       : RB;
+        }
+
+        [[nodiscard]] _Tp lower_bound(const _Tp& val) const {
+            return Base_type::lower_bound(this->root, lo, hi, val);
+        }
+
+        [[nodiscard]] _Tp upper_bound(const _Tp& val) const {
+            return Base_type::upper_bound(this->root, lo, hi, val);
+        }
+    };
+
+    std::array<shard, _Shards> shards;
+
+    [[nodiscard]] static size_t shard_of(const _Tp& val) noexcept {
+        return std::min<size_t>(
+            static_cast<unsigned_type>(static_cast<unsigned_type>(val) -
+                                       static_cast<unsigned_type>(LB)) /
+                SHARD_SPAN,
+            _Shards - 1);
+    }
+
+    void update(const _Tp& val, int action) {
+        shard& s = shards[shard_of(val)];
+        std::unique_lock lock(s.mutex);
+        s.update(val, action);
+    }
+
+    /**
+     * @brief Returns the number of elements less than or equal to @c val, or
+     * strictly less than it if @c strict is set.
+     */
+    [[nodiscard]] size_t rank(const _Tp& val, bool strict) const {
+        if (val < LB || (strict && val == LB))
+            return 0;
+        const size_t id = shard_of(val);
+        size_t result = 0;
+        for (size_t i = 0; i < id; ++i)
+            result += shards[i].size.load(std::memory_order_acquire);
+
+        const shard& s = shards[id];
+        std::shared_lock lock(s.mutex);
+        return result + s.get(s.lo, strict ? val - 1 : val);
+    }
+
+   public:
+    /**
+     * @brief Create a concurrent_ordered_set with no elements.
+     */
+    concurrent_ordered_set() {
+        for (size_t i = 0; i < _Shards; ++i) {
+            std::uintmax_t offset = i * std::uintmax_t(SHARD_SPAN);
+            if (offset > WIDTH) {
+                // more slices than values, this one is never used
+                shards[i].lo = shards[i].hi = RB;
+                continue;
+            }
+            shards[i].lo = static_cast<_Tp>(static_cast<unsigned_type>(LB) +
+                                            static_cast<unsigned_type>(offset));
+            shards[i].hi =
+                WIDTH - offset >= SHARD_SPAN
+                    ? static_cast<_Tp>(shards[i].lo + (SHARD_SPAN - 1))
+                    : RB;
+        }
+    }
+
+    concurrent_ordered_set(const concurrent_ordered_set&) = delete;
+    concurrent_ordered_set& operator=(const concurrent_ordered_set&) = delete;
+
+    /**
+     * @brief Returns one past the largest number allowed to be added.
+     */
+    [[nodiscard]] constexpr _Tp end() const noexcept { return RB; }
+
+    /**
+     * @brief Returns the number of elements in the container.
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        size_t result = 0;
+        for (const shard& s : shards)
+            result += s.size.load(std::memory_order_acquire);
+        return result;
+    }
+
+    /**
+     * @brief Returns true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return !size(); }
+
+    /**
+     * @brief Add a new element into the container.
+     *
+     * @param val Value to be added.
+     */
+    void insert(const _Tp& val) {
+        update(val, shard::NODE_UPDATE_ACTIONS::ADD_ONCE);
+    }
+
+    /**
+     * @brief Remove one occurence of `val` from the container.
+     *
+     * @param val Value to be removed.
+     */
+    void erase_once(const _Tp& val) {
+        update(val, shard::NODE_UPDATE_ACTIONS::REMOVE_ONCE);
+    }
+
+    /**
+     * @brief Remove all occurences of `val` from the container.
+     *
+     * @param val Value to be removed.
+     */
+    void erase_all(const _Tp& val) {
+        update(val, shard::NODE_UPDATE_ACTIONS::REMOVE_ALL);
+    }
+
+    /**
+     * @brief Remove all elements from the container.
+     */
+    void clear() {
+        for (shard& s : shards) {
+            std::unique_lock lock(s.mutex);
+            s.reset();
+        }
+    }
+
+    /**
+     * @brief Returns the number of elements in the range `[l,r]`.
+     */
+    [[nodiscard]] size_t count(_Tp l, _Tp r) const {
+        if (r < l)
+            return 0;
+        size_t upto = rank(r, false), below = rank(l, true);
+        return upto > below ? upto - below : 0;
+    }
+
+    /**
+     * @brief Returns the number of elements less than or equal to @c val.
+     */
+    [[nodiscard]] size_t order_of_key(const _Tp& val) const {
+        return rank(val, false);
+    }
+
+    /**
+     * @brief Returns the k-th (1-based) smallest element in the container.
+     *
+     * @param k The position of the element to find.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp find_by_order(size_t k) const {
+        for (const shard& s : shards) {
+            size_t here = s.size.load(std::memory_order_acquire);
+            if (here < k) {
+                k -= here;
+                continue;
+            }
+            std::shared_lock lock(s.mutex);
+            return s.k_largest(k);
+        }
+        return RB;
+    }
+
+    /**
+     * @brief Returns the smallest value in the container no less than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp lower_bound(const _Tp& val) const {
+        for (size_t i = val < LB ? 0 : shard_of(val); i < _Shards; ++i) {
+            const shard& s = shards[i];
+            if (!s.size.load(std::memory_order_acquire))
+                continue;
+            std::shared_lock lock(s.mutex);
+            _Tp result = s.lower_bound(val);
+            if (result != RB)
+                return result;
+        }
+        return RB;
+    }
+
+    /**
+     * @brief Returns the largest value in the container no more than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp upper_bound(const _Tp& val) const {
+        if (val < LB)
+            return RB;
+        for (size_t i = shard_of(val) + 1; i-- > 0;) {
+            const shard& s = shards[i];
+            if (!s.size.load(std::memory_order_acquire))
+                continue;
+            std::shared_lock lock(s.mutex);
+            _Tp result = s.upper_bound(val);
+            if (result != RB)
+                return result;
+        }
+        return RB;
+    }
+};
+}  // namespace cpdsa
+
+#endif /* CPDSA_CONCURRENT_ORDERED_SET */
@@ -0,0 +1,133 @@
+/**
+ * CPDSA: Lock-free concurrent skip list -*- C++ -*-
+ *
+ * @file include/cpdsa/src/concurrent_skip_list.hpp
+ */
+
+#ifndef CPDSA_CONCURRENT_SKIP_LIST
+#define CPDSA_CONCURRENT_SKIP_LIST
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+#include "base/concurrent_skip_list_base.hpp"
+#include "skip_list.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief A @c skip_list which can be updated and queried from several
+ * threads at once, without locks.
+ *
+ * @tparam _Tp Type of element.
+ * @tparam _Levels Maximum height of the skip list.
+ *
+ * @note Every element is its own node, whose tower of links is updated with
+ * compare-and-swap (see @c concurrent_skip_list_base): @c insert and
+ * @c erase are lock-free, @c contains, @c lower_bound and @c upper_bound only
+ * read. All of them are linearizable and take @a O(log(n)) expected steps
+ * without contention. Removed nodes are freed through @c epoch_domain once
+ * no thread can still be reading them.
+ *
+ * @note Unlike @c skip_list, elements are not packed into blocks:
+ * a block would have to be copied on every update to be published
+ * atomically.
+ */
+template <Skip_list_element_type _Tp, std::size_t _Levels = 24>
+class concurrent_skip_list : private concurrent_skip_list_base<_Tp, _Levels> {
+   private:
+    using Base_type = concurrent_skip_list_base<_Tp, _Levels>;
+    using node = typename Base_type::node;
+
+    template <bool _Upper>
+    std::optional<_Tp> bound(const _Tp& val) const {
+        epoch_domain::guard guard;
+        const node* n = Base_type::template search<_Upper>(val);
+        return n ? std::optional<_Tp>(n->key) : std::nullopt;
+    }
+
+   public:
+    using value_type = _Tp;
+    using size_type = std::size_t;
+
+    /**
+     * @brief Create an empty concurrent_skip_list.
+     */
+    concurrent_skip_list() = default;
+
+    /**
+     * @brief Add @c val into the container.
+     *
+     * @return False if it was already there.
+     */
+    bool insert(const _Tp& val) { return Base_type::insert(val); }
+
+    /**
+     * @brief Remove @c val from the container.
+     *
+     * @return False if it wasn't there.
+     */
+    bool erase(const _Tp& val) { return Base_type::erase(val); }
+
+    /**
+     * @brief Returns true if @c val is in the container.
+     */
+    [[nodiscard]] bool contains(const _Tp& val) const {
+        epoch_domain::guard guard;
+        const node* n = Base_type::template search<false>(val);
+        return n && n->key == val;
+    }
+
+    /**
+     * @brief Returns the first element not less than @c val, if any.
+     */
+    [[nodiscard]] std::optional<_Tp> lower_bound(const _Tp& val) const {
+        return bound<false>(val);
+    }
+
+    /**
+     * @brief Returns the first element greater than @c val, if any.
+     */
+    [[nodiscard]] std::optional<_Tp> upper_bound(const _Tp& val) const {
+        return bound<true>(val);
+    }
+
+    /**
+     * @brief Call @c f on every element, in increasing order. Elements added
+     * or removed meanwhile may or may not be seen.
+     */
+    template <typename _Function>
+    void for_each(_Function f) const {
+        epoch_domain::guard guard;
+        for (node* n = Base_type::pointer(this->head->links()[0].load()); n;) {
+            std::uintptr_t next = n->links()[0].load();
+            if (!Base_type::marked(next))
+                f(n->key);
+            n = Base_type::pointer(next);
+        }
+    }
+
+    /**
+     * @brief Remove all elements. Must not run concurrently with any other
+     * operation.
+     */
+    void clear() noexcept { this->reset(); }
+
+    /**
+     * @brief Returns the number of elements in the container. Exact when no
+     * update is in progress.
+     */
+    [[nodiscard]] size_type size() const noexcept {
+        return this->total.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return !size(); }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_CONCURRENT_SKIP_LIST */
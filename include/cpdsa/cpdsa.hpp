@@ -5,11 +5,27 @@
  */
 
 #if __cplusplus >= 202002L
+#include "./aho_corasick.hpp"
+#include "./bigint.hpp"
+#include "./bucketed_ordered_set.hpp"
+#include "./concurrent_ordered_set.hpp"
+#include "./concurrent_skip_list.hpp"
+#include "./csr_graph.hpp"
+#include "./fast_set.hpp"
 #include "./ordered_set.hpp"
+#include "./ordered_set_2d.hpp"
+#include "./ordered_set_view.hpp"
+#include "./parallel_bfs.hpp"
+#include "./persistent_ordered_set.hpp"
+#include "./skip_list.hpp"
+#include "./string_search.hpp"
+#include "./tree.hpp"
 #endif
 
 #if __cplusplus >= 201102L
 #include "./buffer_scan.hpp"
 #include "./median_heap.hpp"
+#include "./quantile_heap.hpp"
+#include "./quantile_sketch.hpp"
 #include "./radix_sort.hpp"
 #endif
\ No newline at end of file
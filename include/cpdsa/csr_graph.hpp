@@ -0,0 +1,223 @@
+/**
+ * CPDSA: Compressed sparse row graph -*- C++ -*-
+ *
+ * @file include/cpdsa/src/csr_graph.hpp
+ */
+
+#ifndef CPDSA_CSR_GRAPH
+#define CPDSA_CSR_GRAPH
+
+#include <concepts>
+#include <cstddef>
+#include <functional>  // for std::greater
+#include <limits>
+#include <span>
+#include <utility>  // for std::pair
+#include <vector>
+
+#include "base/csr_graph_base.hpp"
+#include "base/quantile_heap_base.hpp"  // for d_ary_heap
+#include "buffer_scan.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief A static graph, with every adjacency list in one contiguous array.
+ *
+ * @tparam _Weight Type of edge weights, or @c void for an unweighted graph.
+ *
+ * @note Vertices are numbered from 0 to @c vertex_count() - 1. Edges are
+ * directed, unless the graph is built as undirected, in which case each edge
+ * is stored once in each direction.
+ *
+ * @note Building takes @a O(n + m) (see @c csr_graph_base). Neighbors of a
+ * vertex come in the order their edges were given.
+ */
+template <typename _Weight = void>
+class csr_graph : private csr_graph_base<_Weight> {
+   private:
+    using Base_type = csr_graph_base<_Weight>;
+
+   public:
+    using vertex_type = typename Base_type::vertex_type;
+    using weight_type = typename Base_type::weight_type;
+    using edge = typename Base_type::edge;
+    using size_type = std::size_t;
+
+    /**
+     * @brief The distance to vertices that cannot be reached.
+     */
+    static constexpr vertex_type UNREACHED =
+        std::numeric_limits<vertex_type>::max();
+
+    /**
+     * @brief Create a graph without vertices.
+     */
+    csr_graph() = default;
+
+    /**
+     * @brief Create a graph with @c n vertices and the given edges.
+     */
+    csr_graph(size_type n, const std::vector<edge>& edges,
+              bool undirected = false) {
+        this->build(n, edges, undirected);
+    }
+
+    /**
+     * @brief Create a graph with @c n vertices, reading @c m edges from
+     * @c stdin with @c buffer_scan: each is two vertices, numbered from
+     * @c first_vertex, followed by its weight for weighted graphs.
+     */
+    static csr_graph scan(size_type n, size_type m, bool undirected = false,
+                          vertex_type first_vertex = 1)
+        requires(!Base_type::WEIGHTED || std::integral<_Weight>)
+    {
+        std::vector<edge> edges(m);
+        for (edge& e : edges) {
+            if constexpr (Base_type::WEIGHTED)
+                buffer_scan(e.from, e.to, e.weight);
+            else
+                buffer_scan(e.from, e.to);
+            e.from -= first_vertex;
+            e.to -= first_vertex;
+        }
+        return csr_graph(n, edges, undirected);
+    }
+
+    /**
+     * @brief Returns the graph with every arc reversed, so that
+     * @c neighbors(v) lists the arcs coming into @c v.
+     */
+    [[nodiscard]] csr_graph transpose() const {
+        csr_graph result;
+        result.build_transpose(*this);
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of vertices.
+     */
+    [[nodiscard]] size_type vertex_count() const noexcept {
+        return this->offsets.size() - 1;
+    }
+
+    /**
+     * @brief Returns the number of stored arcs: twice the number of edges
+     * for undirected graphs.
+     */
+    [[nodiscard]] size_type edge_count() const noexcept {
+        return this->targets.size();
+    }
+
+    [[nodiscard]] size_type degree(vertex_type v) const noexcept {
+        return this->offsets[v + 1] - this->offsets[v];
+    }
+
+    /**
+     * @brief Returns the vertices @c v has an arc to.
+     */
+    [[nodiscard]] std::span<const vertex_type> neighbors(
+        vertex_type v) const noexcept {
+        return {this->targets.data() + this->offsets[v], degree(v)};
+    }
+
+    /**
+     * @brief Returns the weights of the arcs leaving @c v, in the same order
+     * as @c neighbors(v).
+     */
+    [[nodiscard]] std::span<const _Weight> weights(vertex_type v) const noexcept
+        requires(Base_type::WEIGHTED)
+    {
+        return {this->arc_weights.data() + this->offsets[v], degree(v)};
+    }
+
+    /**
+     * @brief Returns the number of arcs on a shortest path from @c source to
+     * every vertex, or @c UNREACHED.
+     */
+    [[nodiscard]] std::vector<vertex_type> bfs(vertex_type source) const {
+        std::vector<vertex_type> dist(vertex_count(), UNREACHED);
+        std::vector<vertex_type> queue(vertex_count());
+        size_type head = 0, tail = 0;
+        dist[source] = 0;
+        queue[tail++] = source;
+        while (head < tail) {
+            const vertex_type v = queue[head++];
+            for (vertex_type u : neighbors(v))
+                if (dist[u] == UNREACHED) {
+                    dist[u] = dist[v] + 1;
+                    queue[tail++] = u;
+                }
+        }
+        return dist;
+    }
+
+    /**
+     * @brief Returns the vertices reachable from @c source, in the order a
+     * recursive depth-first search would first visit them.
+     *
+     * @note Runs on an explicit stack, so that deep graphs can't overflow
+     * the call stack.
+     */
+    [[nodiscard]] std::vector<vertex_type> dfs(vertex_type source) const {
+        std::vector<vertex_type> order;
+        std::vector<bool> visited(vertex_count());
+        // each vertex on the path, with the position of its next arc
+        std::vector<std::pair<vertex_type, size_type>> stack;
+        visited[source] = true;
+        order.push_back(source);
+        stack.emplace_back(source, this->offsets[source]);
+        while (!stack.empty()) {
+            auto& [v, next] = stack.back();
+            if (next == this->offsets[v + 1]) {
+                stack.pop_back();
+                continue;
+            }
+            const vertex_type u = this->targets[next++];
+            if (!visited[u]) {
+                visited[u] = true;
+                order.push_back(u);
+                stack.emplace_back(u, this->offsets[u]);
+            }
+        }
+        return order;
+    }
+
+    /**
+     * @brief Returns the length of a shortest path from @c source to every
+     * vertex, or the largest @c _Weight for those that cannot be reached.
+     * Weights must not be negative.
+     *
+     * @note Runs on a 4-ary heap (see @c d_ary_heap) with lazy deletion, in
+     * @a O((n + m) log(n)).
+     */
+    [[nodiscard]] std::vector<_Weight> dijkstra(vertex_type source) const
+        requires(Base_type::WEIGHTED)
+    {
+        constexpr _Weight INF = std::numeric_limits<_Weight>::max();
+        std::vector<_Weight> dist(vertex_count(), INF);
+        d_ary_heap<std::pair<_Weight, vertex_type>, std::greater<>, 4> heap;
+        dist[source] = _Weight();
+        heap.push({dist[source], source});
+        while (!heap.empty()) {
+            const auto [d, v] = heap.top();
+            heap.pop();
+            if (d != dist[v])
+                continue;
+            for (size_type i = this->offsets[v]; i < this->offsets[v + 1];
+                 ++i) {
+                const vertex_type u = this->targets[i];
+                const _Weight through = d + this->arc_weights[i];
+                if (through < dist[u]) {
+                    dist[u] = through;
+                    heap.push({through, u});
+                }
+            }
+        }
+        return dist;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_CSR_GRAPH */
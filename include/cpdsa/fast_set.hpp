@@ -0,0 +1,141 @@
+/**
+ * CPDSA: 64-ary bitset tree -*- C++ -*-
+ *
+ * @file include/cpdsa/src/fast_set.hpp
+ */
+
+#ifndef CPDSA_FAST_SET
+#define CPDSA_FAST_SET
+
+#include <algorithm>
+
+#include "base/fast_set_base.hpp"
+
+namespace cpdsa {
+/**
+ * @brief A set of distinct integers in `[0, U)` with successor and
+ * predecessor queries in a handful of word operations.
+ *
+ * @tparam U One past the largest value allowed to be added.
+ *
+ * @note Levels of 64-bit words where each bit tells whether the word below
+ * it is non-zero (a van Emde Boas layout with a fan-out of 64). Every
+ * operation takes @a O(log_64(U)) steps, each a word load and a
+ * @c tzcnt / @c lzcnt: 4 steps for @a U = 2^24. Memory is about @a U / 8
+ * bytes, allocated up front.
+ *
+ * @note Unlike @c ordered_set, values are stored at most once.
+ */
+template <size_t U>
+class fast_set : private fast_set_base<U> {
+   private:
+    static_assert(U > 0, "the universe must not be empty");
+
+    using Base_type = fast_set_base<U>;
+
+    size_t total = 0;
+
+   public:
+    /**
+     * @brief Create a fast_set with no elements.
+     */
+    fast_set() = default;
+
+    /**
+     * @brief Returns one past the largest number allowed to be added.
+     */
+    [[nodiscard]] constexpr size_t end() const noexcept { return U; }
+
+    /**
+     * @brief Returns the number of elements in the container.
+     */
+    [[nodiscard]] size_t size() const noexcept { return total; }
+
+    /**
+     * @brief Returns true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return !size(); }
+
+    /**
+     * @brief Add @c val (less than @a U) into the container.
+     *
+     * @return False if it was already there.
+     */
+    bool insert(size_t val) noexcept {
+        if (Base_type::test(val))
+            return false;
+        Base_type::set(val);
+        ++total;
+        return true;
+    }
+
+    /**
+     * @brief Remove @c val (less than @a U) from the container.
+     *
+     * @return False if it wasn't there.
+     */
+    bool erase(size_t val) noexcept {
+        if (!Base_type::test(val))
+            return false;
+        Base_type::reset(val);
+        --total;
+        return true;
+    }
+
+    /**
+     * @brief Remove all elements from the container, in @a O(U / 64).
+     */
+    void clear() noexcept {
+        for (auto& level : this->levels)
+            std::fill(level.begin(), level.end(), 0);
+        total = 0;
+    }
+
+    /**
+     * @brief Returns true if @c val is in the container.
+     */
+    [[nodiscard]] bool contains(size_t val) const noexcept {
+        return val < U && Base_type::test(val);
+    }
+
+    /**
+     * @brief Returns the smallest value in the container no less than @c val.
+     *
+     * @return Either said value or U if no such value exists.
+     */
+    [[nodiscard]] size_t lower_bound(size_t val) const noexcept {
+        return val < U ? Base_type::next(val) : U;
+    }
+
+    /**
+     * @brief Returns the largest value in the container no more than @c val.
+     *
+     * @return Either said value or U if no such value exists.
+     */
+    [[nodiscard]] size_t upper_bound(size_t val) const noexcept {
+        return Base_type::prev(std::min(val, U - 1));
+    }
+
+    /**
+     * @brief Returns the smallest value in the container, or U if it is empty.
+     */
+    [[nodiscard]] size_t front() const noexcept { return Base_type::next(0); }
+
+    /**
+     * @brief Returns the largest value in the container, or U if it is empty.
+     */
+    [[nodiscard]] size_t back() const noexcept { return Base_type::prev(U - 1); }
+
+    /**
+     * @brief Returns the number of bytes held by the container.
+     */
+    [[nodiscard]] size_t memory_usage() const noexcept {
+        size_t result = sizeof(*this);
+        for (const auto& level : this->levels)
+            result += level.capacity() * sizeof(level[0]);
+        return result;
+    }
+};
+}  // namespace cpdsa
+
+#endif /* CPDSA_FAST_SET */
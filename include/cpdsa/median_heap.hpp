@@ -13,20 +13,28 @@
 #include <type_traits>
 #endif
 
-#include <queue>
+#include <cstddef>
+#include <functional>  // for std::hash
+#include <vector>
+
+#include "base/quantile_heap_base.hpp"
 
 namespace cpdsa {
 
 /**
  * @brief Types eligible to be elements of @c median_heap.
  *
- * @note Must be convertible to double because @c median() casts to that type.
+ * @note Must be convertible to double because @c median() casts to that type,
+ * and hashable with @c == because erased elements are kept in a
+ * @c std::unordered_map until they reach the top of their heap.
  */
 #if __cplusplus >= 202002L
 template <typename _Tp>
 concept Median_heap_element_type = requires(_Tp a, _Tp b) {
     a >= b;
     static_cast<double>(a);
+    { a == b } -> std::convertible_to<bool>;
+    { std::hash<_Tp>{}(a) } -> std::convertible_to<std::size_t>;
 };
 #else
 template <typename, typename = void>
@@ -44,6 +52,9 @@ struct has_greater_than_operator<
  * @brief A standard container automatically maintaining its median.
  *
  * @tparam _Tp Type of element.
+ * @tparam _Arity Number of children of every heap node.
+ * @tparam _Track_sums Whether to keep the sum of each heap, for @c sum() and
+ * @c deviation_cost().
  *
  * @note The container employs two smaller containers @c lower_heap and
  * @c higher_heap such that the largest element in @c lower_heap does not
@@ -59,43 +70,41 @@ struct has_greater_than_operator<
  * largest element) is either the largest element in @c lower_heap or
  * the smallest element in @c higher_heap.
  *
+ * @note Erased elements are removed lazily (see @c quantile_heap_base).
+ *
+ * @note Both heaps are @a _Arity-ary heaps over contiguous arrays: with the
+ * default of 4, a heap is half as deep as a binary one and the children of a
+ * node are compared within the same cache line.
  */
 #if __cplusplus >= 202002L
-template <Median_heap_element_type _Tp>
+template <Median_heap_element_type _Tp,
+          std::size_t _Arity = 4,
+          bool _Track_sums = false>
 #else
-template <typename _Tp>
+template <typename _Tp, std::size_t _Arity = 4, bool _Track_sums = false>
 #endif
-class median_heap {
+class median_heap : private quantile_heap_base<_Tp, _Arity, _Track_sums> {
    private:
 #if __cplusplus < 202002L  // C++11/14/17
     static_assert(std::is_convertible<_Tp, double>::value,
                   "median heap element must be convertible to double");
     static_assert(has_greater_than_operator<_Tp>::value,
                   "element type must have > operator");
+    static_assert(is_lazily_erasable<_Tp>::value,
+                  "median heap element must have std::hash and == operator");
 #endif
 
     typedef _Tp value_type;
     typedef const _Tp& const_reference;
 
-    std::priority_queue<value_type> lower_heap;
-    std::priority_queue<value_type,
-                        std::vector<value_type>,
-                        std::greater<value_type>>
-        higher_heap;
+    typedef typename quantile_heap_sum_type<_Tp>::type sum_type;
+
+    typedef quantile_heap_base<_Tp, _Arity, _Track_sums> Base_type;
 
     /**
      * @brief Maintain the size difference between the heaps.
      */
-    void balance() {
-        if (higher_heap.size() - 1 > lower_heap.size()) {
-            lower_heap.push(higher_heap.top());
-            higher_heap.pop();
-        }
-        if (lower_heap.size() > higher_heap.size()) {
-            higher_heap.push(lower_heap.top());
-            lower_heap.pop();
-        }
-    }
+    void balance() { Base_type::balance(size() / 2); }
 
    public:
     /**
@@ -103,17 +112,40 @@ class median_heap {
      */
     median_heap() = default;
 
+    /**
+     *  @brief  Creates a median_heap holding the elements of `[first, last)`,
+     *  in @a O(n): the range is split around its median with
+     *  @c std::nth_element, and each half is heapified in place.
+     */
+    template <typename _InputIt>
+    median_heap(_InputIt first, _InputIt last) {
+        assign(first, last);
+    }
+
     ~median_heap() = default;
 
+    /**
+     *  @brief Replace the contents of the container with `[first, last)`, in
+     *  @a O(n).
+     */
+    template <typename _InputIt>
+    void assign(_InputIt first, _InputIt last) {
+        std::vector<value_type> values(first, last);
+        Base_type::assign(values, values.size() / 2);
+    }
+
+    /**
+     *  @brief Preallocate both heaps for @c n elements, so that pushing up to
+     *  that many never reallocates.
+     */
+    void reserve(std::size_t n) { Base_type::reserve(n / 2 + 1, n / 2 + 1); }
+
     /**
      *  @brief  Add data to the container.
      *  @param x Data to be added.
      */
     void push(const value_type& x) {
-        if (higher_heap.empty() || x >= higher_heap.top())
-            higher_heap.push(x);
-        else
-            lower_heap.push(x);
+        Base_type::insert(x);
         balance();
     }
 
@@ -121,58 +153,94 @@ class median_heap {
      *  @brief Remove the discrete median of the container.
      */
     void pop() {
-        if (lower_heap.size() == higher_heap.size())
-            lower_heap.pop();
+        if (this->lower_size == this->higher_size)
+            Base_type::pop_lower();
         else
-            higher_heap.pop();
+            Base_type::pop_higher();
         balance();
     }
 
     /**
-     *  @brief Remove all elements from the container.
+     *  @brief Remove one occurence of @c x from the container, which must
+     *  hold it.
      *
-     *  @note Really no cleaner way to do this since the heap arrays are
-     * private.
+     *  @note Amortized @a O(log(n)), which makes sliding windows possible.
+     *  An erased element stays in its heap until it surfaces, or until
+     *  erased elements make up half of the heap and it is rebuilt without
+     *  them.
      */
-    void clear() {
-        while (!lower_heap.empty())
-            lower_heap.pop();
-        while (!higher_heap.empty())
-            higher_heap.pop();
+    void erase(const value_type& x) {
+        Base_type::remove(x);
+        balance();
     }
 
+    /**
+     *  @brief Remove all elements from the container, in @a O(1) for
+     *  trivially destructible elements. The memory is kept.
+     */
+    void clear() { this->reset(); }
+
     /**
      *  @return The number of elements in the container.
      */
     [[nodiscard]] std::size_t size() const {
-        return lower_heap.size() + higher_heap.size();
+        return this->lower_size + this->higher_size;
     }
 
     /**
      *  @return @a true if the container is empty.
      */
-    [[nodiscard]] bool empty() const {
-        return lower_heap.empty() && higher_heap.empty();
-    }
+    [[nodiscard]] bool empty() const { return !size(); }
 
     /**
      * @return The discrete median (with a container of size @a n, its
      * @a (n+1)/2-th largest element) of the container.
      */
     [[nodiscard]] const_reference discrete_median() const {
-        if (lower_heap.size() == higher_heap.size())
-            return lower_heap.top();
-        return higher_heap.top();
+        if (this->lower_size == this->higher_size)
+            return this->lower_heap.top();
+        return this->higher_heap.top();
     }
 
     /**
      *  @return The median of the container.
      */
     [[nodiscard]] double median() const {
-        if (lower_heap.size() == higher_heap.size())
-            return static_cast<double>(lower_heap.top() + higher_heap.top()) /
+        if (this->lower_size == this->higher_size)
+            return static_cast<double>(this->lower_heap.top() +
+                                       this->higher_heap.top()) /
                    2;
-        return static_cast<double>(higher_heap.top());
+        return static_cast<double>(this->higher_heap.top());
+    }
+
+    /**
+     *  @return The sum of all elements, in @a O(1). Integers are summed as
+     *  64-bit integers, anything else as double. Requires @a _Track_sums.
+     */
+    [[nodiscard]] sum_type sum() const {
+        static_assert(_Track_sums, "sum() requires _Track_sums");
+        return this->lower_sum + this->higher_sum;
+    }
+
+    /**
+     *  @return The sum of the distances of every element to the median,
+     *  i.e. the least total cost of moving all elements to one value, in
+     *  @a O(1). Requires @a _Track_sums.
+     *
+     *  @note With @a m the discrete median, every element of @c lower_heap
+     *  is at most @a m and every element of @c higher_heap at least @a m,
+     *  so the sum is @a m * |lower| - sum(lower) + sum(higher) -
+     *  @a m * |higher|.
+     */
+    [[nodiscard]] sum_type deviation_cost() const {
+        static_assert(_Track_sums, "deviation_cost() requires _Track_sums");
+        if (empty())
+            return 0;
+        const sum_type m = static_cast<sum_type>(discrete_median());
+        return (m * static_cast<sum_type>(this->lower_size) -
+                this->lower_sum) +
+               (this->higher_sum -
+                m * static_cast<sum_type>(this->higher_size));
     }
 };
 }  // namespace cpdsa
@@ -7,9 +7,18 @@
 #ifndef CPDSA_ORDERED_SET
 #define CPDSA_ORDERED_SET
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 
+#include "base/flat_ordered_set_base.hpp"
 #include "base/ordered_set_base.hpp"
+#include "base/ordered_set_snapshot_base.hpp"
+#include "radix_sort.hpp"
 
 namespace cpdsa {
 /**
@@ -24,6 +33,9 @@ namespace cpdsa {
  * @note An implementation of a dynamic segment tree. Operations
  * have time complexity @a O(log(X)) where @a X = @a RB - @a LB. @a LB and @a RB
  * must be specified if @c std::numeric_limits<_Tp> is not provided.
+ *
+ * @note When @a X is at most @c CPDSA_ORDERED_SET_FLAT_LIMIT, a flat Fenwick
+ * tree is used instead (see the specialization below).
  */
 template <std::integral _Tp,
           _Tp LB = std::numeric_limits<_Tp>::min(),
@@ -31,8 +43,99 @@ template <std::integral _Tp,
 class ordered_set : private ordered_set_base<_Tp, LB, RB> {
    private:
     using Base_type = ordered_set_base<_Tp, LB, RB>;
+    using Snapshot_type = ordered_set_snapshot_base<_Tp, LB, RB>;
+    using header_type = typename Snapshot_type::header_type;
+    using record_type = typename Snapshot_type::record_type;
+
+    /**
+     * @brief Sort a batch of queries, remembering where each one came from.
+     *
+     * @param first Start of the queries.
+     * @param last End of the queries.
+     * @param vals Receives the queries in increasing order.
+     * @param order Receives, for each sorted query, its original position.
+     *
+     * @note For types up to 32 bits wide the value and its position are
+     * packed into one 64-bit key and @c radix_sort is used; otherwise this
+     * falls back to @c std::sort.
+     */
+    template <std::input_iterator _InputIt>
+    static void sort_queries(_InputIt first,
+                             _InputIt last,
+                             std::vector<_Tp>& vals,
+                             std::vector<size_t>& order) {
+        vals.assign(first, last);
+        const size_t n = vals.size();
+        order.resize(n);
+
+        if constexpr (sizeof(_Tp) <= sizeof(std::uint32_t)) {
+            if (n <= std::numeric_limits<std::uint32_t>::max()) {
+                using unsigned_type = std::make_unsigned_t<_Tp>;
+                // same trick as __flip_sign_bit, so that keys order like _Tp
+                constexpr unsigned_type flip =
+                    std::is_signed_v<_Tp>
+                        ? static_cast<unsigned_type>(
+                              std::numeric_limits<_Tp>::min())
+                        : 0;
+                std::vector<std::uint64_t> keys(n);
+                for (size_t i = 0; i < n; ++i) {
+                    std::uint64_t key =
+                        static_cast<unsigned_type>(vals[i]) ^ flip;
+                    keys[i] = (key << 32) | i;
+                }
+                radix_sort<16>(keys.begin(), keys.end());
+                for (size_t i = 0; i < n; ++i) {
+                    vals[i] = static_cast<_Tp>(
+                        static_cast<unsigned_type>(keys[i] >> 32) ^ flip);
+                    order[i] = static_cast<std::uint32_t>(keys[i]);
+                }
+                return;
+            }
+        }
+
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(),
+                  [&](size_t a, size_t b) { return vals[a] < vals[b]; });
+        std::vector<_Tp> sorted(n);
+        for (size_t i = 0; i < n; ++i)
+            sorted[i] = vals[order[i]];
+        vals.swap(sorted);
+    }
+
+    /**
+     * @brief Rank every query of a batch (see @c batch_rank) and scatter the
+     * answers back into their original positions.
+     */
+    template <std::input_iterator _InputIt,
+              std::random_access_iterator _OutputIt>
+    void rank_all(_InputIt first,
+                  _InputIt last,
+                  _OutputIt d_first,
+                  bool strict) const {
+        std::vector<_Tp> vals;
+        std::vector<size_t> order;
+        sort_queries(first, last, vals, order);
+
+        std::vector<size_t> answers(vals.size());
+        const _Tp* begin = vals.data();
+        const _Tp* end = vals.data() + vals.size();
+        // Queries outside of [LB, RB] never reach the tree.
+        const _Tp* lo = std::lower_bound(begin, end, LB);
+        const _Tp* hi = std::upper_bound(lo, end, RB);
+        std::fill(answers.begin() + (hi - begin), answers.end(), size());
+        Base_type::batch_rank(this->root, LB, RB, lo, hi, 0,
+                              answers.data() + (lo - begin), strict);
+
+        for (size_t i = 0; i < answers.size(); ++i)
+            d_first[order[i]] = answers[i];
+    }
 
    public:
+    /**
+     * @brief Type used for sums of elements, wide enough not to overflow.
+     */
+    using sum_type = ordered_set_sum_type<_Tp>;
+
     /**
      * @brief Create an ordered_set with no elements.
      */
@@ -47,7 +150,7 @@ class ordered_set : private ordered_set_base<_Tp, LB, RB> {
      * @brief Returns the number of elements in the container.
      */
     [[nodiscard]] constexpr size_t size() const noexcept {
-        return this->root->cnt;
+        return this->root.cnt;
     }
 
     /**
@@ -61,7 +164,7 @@ class ordered_set : private ordered_set_base<_Tp, LB, RB> {
      * @param val Value to be added.
      */
     constexpr void insert(const _Tp& val) {
-        Base_type::update(*(this->root), LB, RB, val,
+        Base_type::update(this->root, LB, RB, val,
                           Base_type::NODE_UPDATE_ACTIONS::ADD_ONCE);
     }
 
@@ -72,7 +175,7 @@ class ordered_set : private ordered_set_base<_Tp, LB, RB> {
      * @param val Value to be removed.
      */
     constexpr void erase_once(const _Tp& val) {
-        Base_type::update(*(this->root), LB, RB, val,
+        Base_type::update(this->root, LB, RB, val,
                           Base_type::NODE_UPDATE_ACTIONS::REMOVE_ONCE);
     }
 
@@ -82,28 +185,142 @@ class ordered_set : private ordered_set_base<_Tp, LB, RB> {
      * @param val Value to be removed.
      */
     constexpr void erase_all(const _Tp& val) {
-        Base_type::update(*(this->root), LB, RB, val,
+        Base_type::update(this->root, LB, RB, val,
                           Base_type::NODE_UPDATE_ACTIONS::REMOVE_ALL);
     }
 
     /**
      * @brief Remove all elements from the container.
      */
-    void clear() { this = new ordered_set(); }
+    void clear() { this->reset(); }
+
+    /**
+     * @brief Move every element of @c other into this container.
+     *
+     * @note Nodes are relinked rather than copied (segment tree merging):
+     * merging sets holding @a n elements in total, in any order, costs
+     * @a O(n log(X)) overall.
+     */
+    void merge(ordered_set&& other) {
+        Base_type::merge_nodes(this->root, other.root, LB, RB);
+        other.reset();
+    }
+
+    /**
+     * @brief Move every element greater than @c val out of this container.
+     *
+     * @return A container holding said elements.
+     *
+     * @note Only the path to @c val is visited, in @a O(log(X)).
+     */
+    [[nodiscard]] ordered_set split(const _Tp& val) {
+        ordered_set result;
+        if (val < LB)
+            std::swap(this->root, result.root);
+        else if (val < RB)
+            Base_type::split_nodes(this->root, result.root, LB, RB, val);
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of tree nodes currently allocated.
+     *
+     * @note Walks the whole tree, so this takes time linear in its result.
+     * Since emptied subtrees are freed on erase, it is at most @a O(n log(X))
+     * for @a n elements, whatever the history of the container.
+     */
+    [[nodiscard]] size_t node_count() const noexcept {
+        return Base_type::count_nodes(this->root);
+    }
+
+    /**
+     * @brief Returns the number of bytes held by the container.
+     *
+     * @note Same cost as @c node_count.
+     */
+    [[nodiscard]] size_t memory_usage() const noexcept {
+        return sizeof(*this) + (node_count() - 1) * Base_type::node_size();
+    }
+
+    /**
+     * @brief Write the container to @c path as a flat array of nodes, with
+     * children referred to by index rather than by pointer.
+     *
+     * @return False on any I/O error.
+     *
+     * @note The file can be loaded back with @c load, or served as is through
+     * an @c ordered_set_view with the same template arguments.
+     */
+    bool save(const char* path) const {
+        std::vector<record_type> records;
+        Base_type::flatten(this->root, records);
+        return Snapshot_type::write_file(
+            path,
+            Snapshot_type::make_header(header_type::TREE, records.size()),
+            records);
+    }
+
+    /**
+     * @brief Replace the contents of the container with a file written by
+     * @c save.
+     *
+     * @return False, leaving the container untouched, if the file can't be
+     * read, is corrupt or was written by an ordered_set of another type.
+     */
+    bool load(const char* path) {
+        std::vector<record_type> records;
+        auto size_records = [&](std::uint64_t n) {
+            records.resize(n);
+            return n > 0;
+        };
+        if (!Snapshot_type::read_file(path, header_type::TREE,
+                                      sizeof(record_type), size_records,
+                                      records) ||
+            !Snapshot_type::check_records(records.data(), records.size()))
+            return false;
+        this->reset();
+        Base_type::unflatten(this->root, records.data(), 0);
+        return true;
+    }
 
     /**
      * @brief Returns the number of elements in the range `[l,r]`.
      *
      */
     [[nodiscard]] constexpr int count(_Tp l, _Tp r) const noexcept {
-        return Base_type::get(*(this->root), LB, RB, l, r);
+        return Base_type::get(this->root, LB, RB, l, r);
+    }
+
+    /**
+     * @brief Returns the sum of the elements in the range `[l,r]`.
+     */
+    [[nodiscard]] constexpr sum_type sum(_Tp l, _Tp r) const noexcept {
+        return Base_type::range_sum(this->root, LB, RB, l, r);
+    }
+
+    /**
+     * @brief Returns the sum of the @c k smallest elements (of all elements if
+     * there are fewer than @c k), in one descent of the tree.
+     */
+    [[nodiscard]] constexpr sum_type sum_of_smallest(size_t k) const noexcept {
+        return Base_type::smallest_sum(this->root, LB, RB, std::min(k, size()));
+    }
+
+    /**
+     * @brief Returns the sum of the @c k largest elements (of all elements if
+     * there are fewer than @c k), in one descent of the tree.
+     */
+    [[nodiscard]] constexpr sum_type sum_of_largest(size_t k) const noexcept {
+        return this->root.sum -
+               Base_type::smallest_sum(this->root, LB, RB,
+                                       size() - std::min(k, size()));
     }
 
     /**
      * @brief Returns the number of elements less than or equal to @c val.
      */
     [[nodiscard]] constexpr int order_of_key(const _Tp& val) const noexcept {
-        return Base_type::get(*(this->root), LB, RB, LB, val);
+        return Base_type::get(this->root, LB, RB, LB, val);
     }
 
     /**
@@ -115,7 +332,7 @@ class ordered_set : private ordered_set_base<_Tp, LB, RB> {
      */
     [[nodiscard]] constexpr _Tp find_by_order(const size_t& k) const noexcept {
         if (size() >= k)
-            return Base_type::k_largest(*(this->root), LB, RB, k);
+            return Base_type::k_largest(this->root, LB, RB, k);
         else
             return RB;
     }
@@ -126,7 +343,7 @@ class ordered_set : private ordered_set_base<_Tp, LB, RB> {
      * @return Either said value or RB if no such value exists.
      */
     [[nodiscard]] constexpr _Tp lower_bound(const _Tp& val) const noexcept {
-        return Base_type::lower_bound(*(this->root), LB, RB, val);
+        return Base_type::lower_bound(this->root, LB, RB, val);
     }
 
     /**
@@ -135,7 +352,350 @@ class ordered_set : private ordered_set_base<_Tp, LB, RB> {
      * @return Either said value or RB if no such value exists.
      */
     [[nodiscard]] constexpr _Tp upper_bound(const _Tp& val) const noexcept {
-        return Base_type::upper_bound(*(this->root), LB, RB, val);
+        return Base_type::upper_bound(this->root, LB, RB, val);
+    }
+
+    /**
+     * @brief Batched @c order_of_key: for each value in `[first, last)`, write
+     * the number of elements less than or equal to it into the matching
+     * position of @c d_first.
+     *
+     * @note Queries are sorted (see @c radix_sort) and answered in one shared
+     * traversal of the tree, which is much friendlier to the cache than
+     * issuing them one by one.
+     */
+    template <std::input_iterator _InputIt,
+              std::random_access_iterator _OutputIt>
+    void order_of_key(_InputIt first, _InputIt last, _OutputIt d_first) const {
+        rank_all(first, last, d_first, false);
+    }
+
+    /**
+     * @brief Batched @c count: for each @a i, write the number of elements in
+     * the range `[l_first[i], r_first[i]]` into @c d_first[i].
+     */
+    template <std::random_access_iterator _InputIt,
+              std::random_access_iterator _OutputIt>
+    void count(_InputIt l_first,
+               _InputIt l_last,
+               _InputIt r_first,
+               _OutputIt d_first) const {
+        const size_t n = std::distance(l_first, l_last);
+        std::vector<size_t> below(n), upto(n);
+        rank_all(l_first, l_last, below.begin(), true);
+        rank_all(r_first, r_first + n, upto.begin(), false);
+        for (size_t i = 0; i < n; ++i)
+            d_first[i] = upto[i] > below[i] ? upto[i] - below[i] : 0;
+    }
+
+    /**
+     * @brief Batched @c lower_bound: for each value in `[first, last)`, write
+     * the smallest element no less than it (or RB if no such element exists)
+     * into the matching position of @c d_first.
+     */
+    template <std::input_iterator _InputIt,
+              std::random_access_iterator _OutputIt>
+    void lower_bound(_InputIt first, _InputIt last, _OutputIt d_first) const {
+        std::vector<_Tp> vals;
+        std::vector<size_t> order;
+        sort_queries(first, last, vals, order);
+
+        // Queries below LB all share the answer of lower_bound(LB).
+        for (auto& val : vals)
+            val = std::max(val, LB);
+
+        std::vector<_Tp> answers(vals.size());
+        const _Tp* begin = vals.data();
+        const _Tp* end = vals.data() + vals.size();
+        const _Tp* hi = std::upper_bound(begin, end, RB);
+        std::fill(answers.begin() + (hi - begin), answers.end(), RB);
+        Base_type::batch_lower_bound(this->root, LB, RB, begin, hi,
+                                     answers.data());
+
+        for (size_t i = 0; i < answers.size(); ++i)
+            d_first[order[i]] = answers[i];
+    }
+};
+
+/**
+ * @brief @c ordered_set over a small universe.
+ *
+ * @note Same interface and complexity as the general @c ordered_set, but backed
+ * by a Fenwick tree of `RB - LB` counters allocated up front instead of a
+ * pointer-based tree: no allocation on insert and far better locality.
+ * @c find_by_order uses binary lifting over the Fenwick tree.
+ */
+template <std::integral _Tp, _Tp LB, _Tp RB>
+    requires Flat_ordered_set_range<_Tp, LB, RB>
+class ordered_set<_Tp, LB, RB> : private flat_ordered_set_base<_Tp, LB, RB> {
+   private:
+    using Base_type = flat_ordered_set_base<_Tp, LB, RB>;
+    using Snapshot_type = ordered_set_snapshot_base<_Tp, LB, RB>;
+    using header_type = typename Snapshot_type::header_type;
+
+   public:
+    /**
+     * @brief Type used for sums of elements, wide enough not to overflow.
+     */
+    using sum_type = ordered_set_sum_type<_Tp>;
+
+    /**
+     * @brief Create an ordered_set with no elements.
+     */
+    ordered_set() = default;
+
+    /**
+     * @brief Returns one past the largest number allowed to be added.
+     */
+    [[nodiscard]] constexpr _Tp end() const noexcept { return RB; }
+
+    /**
+     * @brief Returns the number of elements in the container.
+     */
+    [[nodiscard]] constexpr size_t size() const noexcept {
+        return this->total;
+    }
+
+    /**
+     * @brief Returns true if the container is empty.
+     */
+    [[nodiscard]] constexpr bool empty() const noexcept { return !size(); }
+
+    /**
+     * @brief Add a new element into the container.
+     *
+     * @param val Value to be added.
+     */
+    void insert(const _Tp& val) { this->add(Base_type::slot(val), 1); }
+
+    /**
+     * @brief Remove one occurence of `val` from the
+     * container.
+     *
+     * @param val Value to be removed.
+     */
+    void erase_once(const _Tp& val) {
+        size_t i = Base_type::slot(val);
+        if (this->point(i))
+            this->add(i, -1);
+    }
+
+    /**
+     * @brief Remove all occurences of `val` from the container.
+     *
+     * @param val Value to be removed.
+     */
+    void erase_all(const _Tp& val) {
+        size_t i = Base_type::slot(val);
+        this->add(i, -this->point(i));
+    }
+
+    /**
+     * @brief Remove all elements from the container.
+     */
+    void clear() {
+        std::fill(this->tree.begin(), this->tree.end(), 0);
+        std::fill(this->sums.begin(), this->sums.end(), 0);
+        this->total = 0;
+    }
+
+    /**
+     * @brief Move every element of @c other into this container.
+     *
+     * @note Fenwick trees add up slot by slot, in @a O(X).
+     */
+    void merge(ordered_set&& other) {
+        for (size_t i = 1; i <= Base_type::SIZE; ++i) {
+            this->tree[i] += other.tree[i];
+            this->sums[i] += other.sums[i];
+        }
+        this->total += other.total;
+        other.clear();
+    }
+
+    /**
+     * @brief Move every element greater than @c val out of this container.
+     *
+     * @return A container holding said elements.
+     *
+     * @note Both Fenwick trees are rebuilt, in @a O(X).
+     */
+    [[nodiscard]] ordered_set split(const _Tp& val) {
+        ordered_set result;
+        const size_t cut = Base_type::slot_at_most(val);
+        this->unroll();
+        for (size_t i = cut + 1; i <= Base_type::SIZE; ++i) {
+            std::swap(this->tree[i], result.tree[i]);
+            std::swap(this->sums[i], result.sums[i]);
+        }
+        this->roll();
+        result.roll();
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of Fenwick tree slots, which is fixed.
+     */
+    [[nodiscard]] size_t node_count() const noexcept {
+        return this->tree.size();
+    }
+
+    /**
+     * @brief Returns the number of bytes held by the container.
+     */
+    [[nodiscard]] size_t memory_usage() const noexcept {
+        return sizeof(*this) + this->tree.capacity() * sizeof(int) +
+               this->sums.capacity() * sizeof(sum_type);
+    }
+
+    /**
+     * @brief Write the container to @c path, as a raw dump of the Fenwick
+     * arrays.
+     *
+     * @return False on any I/O error.
+     */
+    bool save(const char* path) const {
+        return Snapshot_type::write_file(
+            path,
+            Snapshot_type::make_header(header_type::FLAT, this->tree.size()),
+            this->tree, this->sums);
+    }
+
+    /**
+     * @brief Replace the contents of the container with a file written by
+     * @c save.
+     *
+     * @return False, leaving the container empty, if the file can't be read
+     * or was written by an ordered_set of another type.
+     */
+    bool load(const char* path) {
+        auto check_size = [](std::uint64_t n) {
+            return n == Base_type::SIZE + 1;
+        };
+        if (!Snapshot_type::read_file(
+                path, header_type::FLAT,
+                sizeof(this->tree[0]) + sizeof(this->sums[0]), check_size,
+                this->tree, this->sums)) {
+            clear();
+            return false;
+        }
+        this->total = this->prefix(Base_type::SIZE);
+        return true;
+    }
+
+    /**
+     * @brief Returns the number of elements in the range `[l,r]`.
+     *
+     */
+    [[nodiscard]] int count(_Tp l, _Tp r) const noexcept {
+        if (r < l)
+            return 0;
+        return this->prefix(Base_type::slot_at_most(r)) -
+               (l > LB ? this->prefix(Base_type::slot_at_most(l - 1)) : 0);
+    }
+
+    /**
+     * @brief Returns the sum of the elements in the range `[l,r]`.
+     */
+    [[nodiscard]] sum_type sum(_Tp l, _Tp r) const noexcept {
+        if (r < l)
+            return 0;
+        return this->prefix_sum(Base_type::slot_at_most(r)) -
+               (l > LB ? this->prefix_sum(Base_type::slot_at_most(l - 1)) : 0);
+    }
+
+    /**
+     * @brief Returns the sum of the @c k smallest elements (of all elements if
+     * there are fewer than @c k).
+     */
+    [[nodiscard]] sum_type sum_of_smallest(size_t k) const noexcept {
+        return this->lift_sum(std::min(k, size()));
+    }
+
+    /**
+     * @brief Returns the sum of the @c k largest elements (of all elements if
+     * there are fewer than @c k).
+     */
+    [[nodiscard]] sum_type sum_of_largest(size_t k) const noexcept {
+        return this->lift_sum(size()) -
+               this->lift_sum(size() - std::min(k, size()));
+    }
+
+    /**
+     * @brief Returns the number of elements less than or equal to @c val.
+     */
+    [[nodiscard]] int order_of_key(const _Tp& val) const noexcept {
+        return this->prefix(Base_type::slot_at_most(val));
+    }
+
+    /**
+     * @brief Returns the k-th (1-based) largest element in the container.
+     *
+     * @param k The position of the element to find.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp find_by_order(const size_t& k) const noexcept {
+        if (k == 0 || k > size())
+            return RB;
+        return Base_type::value(this->lift(k));
+    }
+
+    /**
+     * @brief Returns the smallest value in the container no less than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp lower_bound(const _Tp& val) const noexcept {
+        if (val <= LB)
+            return find_by_order(1);
+        return find_by_order(order_of_key(val - 1) + 1);
+    }
+
+    /**
+     * @brief Returns the largest value in the container no more than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp upper_bound(const _Tp& val) const noexcept {
+        size_t rank = order_of_key(val);
+        return rank ? find_by_order(rank) : RB;
+    }
+
+    /**
+     * @brief Batched @c order_of_key (see the general @c ordered_set).
+     *
+     * @note Queries are already cheap and local here, so they are simply
+     * answered in order.
+     */
+    template <std::input_iterator _InputIt,
+              std::random_access_iterator _OutputIt>
+    void order_of_key(_InputIt first, _InputIt last, _OutputIt d_first) const {
+        for (; first != last; ++first, ++d_first)
+            *d_first = order_of_key(*first);
+    }
+
+    /**
+     * @brief Batched @c count (see the general @c ordered_set).
+     */
+    template <std::random_access_iterator _InputIt,
+              std::random_access_iterator _OutputIt>
+    void count(_InputIt l_first,
+               _InputIt l_last,
+               _InputIt r_first,
+               _OutputIt d_first) const {
+        for (; l_first != l_last; ++l_first, ++r_first, ++d_first)
+            *d_first = count(*l_first, *r_first);
+    }
+
+    /**
+     * @brief Batched @c lower_bound (see the general @c ordered_set).
+     */
+    template <std::input_iterator _InputIt,
+              std::random_access_iterator _OutputIt>
+    void lower_bound(_InputIt first, _InputIt last, _OutputIt d_first) const {
+        for (; first != last; ++first, ++d_first)
+            *d_first = lower_bound(*first);
     }
 };
 }  // namespace cpdsa
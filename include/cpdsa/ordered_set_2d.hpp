@@ -0,0 +1,117 @@
+/**
+ * CPDSA: Two-dimensional ordered set -*- C++ -*-
+ *
+ * @file include/cpdsa/src/ordered_set_2d.hpp
+ */
+
+#ifndef CPDSA_ORDERED_SET_2D
+#define CPDSA_ORDERED_SET_2D
+
+#include <limits>
+
+#include "base/ordered_set_2d_base.hpp"
+
+namespace cpdsa {
+/**
+ * @brief A container of points allowing for online rectangle counting.
+ *
+ * @tparam _Tp Type of coordinate. Must be discrete (i.e.
+ * @c std::integral<_Tp> must holds true).
+ * @tparam LB The smallest coordinate allowed to be added.
+ * @tparam RB One past the largest coordinate allowed to be added.
+ *
+ * @note A dynamic segment tree on x whose nodes each own an ordered set of y
+ * (a segment tree of segment trees). Updates and queries take
+ * @a O(log(X)^2) where @a X = @a RB - @a LB, and memory grows with the points
+ * actually inserted: @a O(n log(X)) outer nodes, each inner set being
+ * bucketed (see @c bucketed_ordered_set).
+ */
+template <std::integral _Tp,
+          _Tp LB = std::numeric_limits<_Tp>::min(),
+          _Tp RB = std::numeric_limits<_Tp>::max()>
+class ordered_set_2d : private ordered_set_2d_base<_Tp, LB, RB> {
+   private:
+    using Base_type = ordered_set_2d_base<_Tp, LB, RB>;
+
+   public:
+    /**
+     * @brief Create an ordered_set_2d with no points.
+     */
+    ordered_set_2d() = default;
+
+    /**
+     * @brief Returns one past the largest coordinate allowed to be added.
+     */
+    [[nodiscard]] constexpr _Tp end() const noexcept { return RB; }
+
+    /**
+     * @brief Returns the number of points in the container.
+     */
+    [[nodiscard]] size_t size() const noexcept { return this->root.ys.size(); }
+
+    /**
+     * @brief Returns true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return !size(); }
+
+    /**
+     * @brief Add the point `(x, y)` into the container.
+     */
+    void insert(const _Tp& x, const _Tp& y) {
+        Base_type::update(this->root, LB, RB, x, y,
+                          Base_type::NODE_UPDATE_ACTIONS::ADD_ONCE);
+    }
+
+    /**
+     * @brief Remove one occurence of the point `(x, y)` from the container.
+     *
+     * @return False if there was no such point.
+     */
+    bool erase_once(const _Tp& x, const _Tp& y) {
+        if (!Base_type::multiplicity(x, y))
+            return false;
+        Base_type::update(this->root, LB, RB, x, y,
+                          Base_type::NODE_UPDATE_ACTIONS::REMOVE_ONCE);
+        return true;
+    }
+
+    /**
+     * @brief Remove all points from the container.
+     */
+    void clear() { this->reset(); }
+
+    /**
+     * @brief Returns the number of copies of the point `(x, y)`.
+     */
+    [[nodiscard]] int count(const _Tp& x, const _Tp& y) const {
+        return Base_type::multiplicity(x, y);
+    }
+
+    /**
+     * @brief Returns the number of points in the rectangle
+     * `[x1,x2] x [y1,y2]`.
+     */
+    [[nodiscard]] int count(const _Tp& x1,
+                            const _Tp& x2,
+                            const _Tp& y1,
+                            const _Tp& y2) const {
+        if (x2 < x1 || y2 < y1)
+            return 0;
+        return Base_type::get(this->root, LB, RB, x1, x2, y1, y2);
+    }
+
+    /**
+     * @brief Returns the number of bytes held by the container.
+     *
+     * @note Walks every node, inner ones included.
+     */
+    [[nodiscard]] size_t memory_usage() const noexcept {
+        size_t inner = 0;
+        size_t nodes = Base_type::count_nodes(this->root, inner);
+        return sizeof(*this) - sizeof(this->root.ys) + inner +
+               (nodes - 1) * Base_type::node_size();
+    }
+};
+}  // namespace cpdsa
+
+#endif /* CPDSA_ORDERED_SET_2D */
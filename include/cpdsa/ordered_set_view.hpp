@@ -0,0 +1,256 @@
+/**
+ * CPDSA: Read-only ordered set over a snapshot file -*- C++ -*-
+ *
+ * @file include/cpdsa/src/ordered_set_view.hpp
+ */
+
+#ifndef CPDSA_ORDERED_SET_VIEW
+#define CPDSA_ORDERED_SET_VIEW
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CPDSA_ORDERED_SET_VIEW_MMAP 1
+#endif
+
+#include "base/ordered_set_snapshot_base.hpp"
+
+namespace cpdsa {
+/**
+ * @brief Read-only queries on a file written by @c ordered_set::save.
+ *
+ * @tparam _Tp Type of element. Must be discrete (i.e. @c std::integral<_Tp>
+ * must holds true).
+ * @tparam LB The smallest value allowed to be added.
+ * @tparam RB One past the largest value allowed to be added.
+ *
+ * @note The template arguments must be those of the ordered_set which wrote
+ * the file. Where @c mmap is available the file is mapped and queried in
+ * place, so opening it costs nothing but a header check no matter its size;
+ * pages are brought in by the queries that touch them. Elsewhere the file is
+ * read into memory instead.
+ *
+ * @note Records are not checked when opening, only bounds-checked as queries
+ * follow them: a corrupt file gives wrong answers but never reads out of
+ * the file. @c verify checks them all once.
+ *
+ * @note Only snapshots of the tree backend can be viewed, not those of the
+ * flat one (see @c CPDSA_ORDERED_SET_FLAT_LIMIT).
+ */
+template <std::integral _Tp,
+          _Tp LB = std::numeric_limits<_Tp>::min(),
+          _Tp RB = std::numeric_limits<_Tp>::max()>
+class ordered_set_view : private ordered_set_snapshot_base<_Tp, LB, RB> {
+   private:
+    using Base_type = ordered_set_snapshot_base<_Tp, LB, RB>;
+    using header_type = typename Base_type::header_type;
+    using record_type = typename Base_type::record_type;
+
+    const record_type* nodes = nullptr;
+    std::uint64_t records = 0;
+    void* mapping = nullptr;
+    size_t mapping_size = 0;
+    std::vector<record_type> buffer;  // when the file could not be mapped
+
+    /**
+     * @brief Map @c path, returning false if it isn't a valid snapshot.
+     */
+    bool map(const char* path) {
+#ifdef CPDSA_ORDERED_SET_VIEW_MMAP
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (::fstat(fd, &info) != 0 ||
+            static_cast<size_t>(info.st_size) < sizeof(header_type)) {
+            ::close(fd);
+            return false;
+        }
+        void* addr =
+            ::mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);  // the mapping keeps the file alive
+        if (addr == MAP_FAILED)
+            return false;
+
+        const header_type& header = *static_cast<const header_type*>(addr);
+        if (!Base_type::check_header(header, header_type::TREE,
+                                     sizeof(record_type), info.st_size) ||
+            header.records == 0) {
+            ::munmap(addr, info.st_size);
+            return false;
+        }
+        mapping = addr;
+        mapping_size = info.st_size;
+        records = header.records;
+        nodes = reinterpret_cast<const record_type*>(
+            static_cast<const char*>(addr) + sizeof(header_type));
+        return true;
+#else
+        (void)path;
+        return false;
+#endif
+    }
+
+   public:
+    /**
+     * @brief Create a view of nothing, holding no elements.
+     */
+    ordered_set_view() = default;
+
+    /**
+     * @brief Create a view of @c path (see @c open).
+     */
+    explicit ordered_set_view(const char* path) { open(path); }
+
+    ordered_set_view(const ordered_set_view&) = delete;
+    ordered_set_view& operator=(const ordered_set_view&) = delete;
+
+    ordered_set_view(ordered_set_view&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    ordered_set_view& operator=(ordered_set_view&& other) noexcept {
+        if (this != &other) {
+            close();
+            std::swap(nodes, other.nodes);
+            std::swap(records, other.records);
+            std::swap(mapping, other.mapping);
+            std::swap(mapping_size, other.mapping_size);
+            buffer.swap(other.buffer);
+        }
+        return *this;
+    }
+
+    ~ordered_set_view() { close(); }
+
+    /**
+     * @brief Start viewing @c path, a file written by @c ordered_set::save.
+     *
+     * @return False, leaving the view empty, if the file can't be read or was
+     * written by an ordered_set of another type.
+     *
+     * @note Only the header and the file size are checked, in @a O(1) when
+     * the file is mapped; see @c verify for the records.
+     */
+    bool open(const char* path) {
+        close();
+        if (map(path))
+            return true;
+        auto size_records = [&](std::uint64_t n) {
+            buffer.resize(n);
+            return n > 0;
+        };
+        if (!Base_type::read_file(path, header_type::TREE, sizeof(record_type),
+                                  size_records, buffer)) {
+            buffer.clear();
+            return false;
+        }
+        nodes = buffer.data();
+        records = buffer.size();
+        return true;
+    }
+
+    /**
+     * @brief Returns whether the records of the file are consistent (see
+     * @c ordered_set_snapshot_base::check_records), e.g. for a file that
+     * may have been truncated or corrupted.
+     *
+     * @note Takes @a O(n), reading the whole file in.
+     */
+    [[nodiscard]] bool verify() const {
+        return nodes != nullptr && Base_type::check_records(nodes, records);
+    }
+
+    /**
+     * @brief Stop viewing the current file, if any.
+     */
+    void close() noexcept {
+#ifdef CPDSA_ORDERED_SET_VIEW_MMAP
+        if (mapping != nullptr)
+            ::munmap(mapping, mapping_size);
+#endif
+        mapping = nullptr;
+        mapping_size = 0;
+        nodes = nullptr;
+        records = 0;
+        buffer.clear();
+    }
+
+    /**
+     * @brief Returns true if the file is queried in place rather than from a
+     * copy.
+     */
+    [[nodiscard]] bool is_mapped() const noexcept { return mapping != nullptr; }
+
+    /**
+     * @brief Returns one past the largest number allowed to be added.
+     */
+    [[nodiscard]] constexpr _Tp end() const noexcept { return RB; }
+
+    /**
+     * @brief Returns the number of elements in the file.
+     */
+    [[nodiscard]] size_t size() const noexcept {
+        return nodes != nullptr && nodes[0].cnt > 0 ? nodes[0].cnt : 0;
+    }
+
+    /**
+     * @brief Returns true if the file holds no elements.
+     */
+    [[nodiscard]] bool empty() const noexcept { return !size(); }
+
+    /**
+     * @brief Returns the number of elements in the range `[l,r]`.
+     */
+    [[nodiscard]] int count(_Tp l, _Tp r) const noexcept {
+        return empty() ? 0 : Base_type::get(nodes, records, 0, LB, RB, l, r);
+    }
+
+    /**
+     * @brief Returns the number of elements less than or equal to @c val.
+     */
+    [[nodiscard]] int order_of_key(const _Tp& val) const noexcept {
+        return count(LB, val);
+    }
+
+    /**
+     * @brief Returns the k-th (1-based) smallest element.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp find_by_order(const size_t& k) const noexcept {
+        if (k && size() >= k)
+            return Base_type::k_largest(nodes, records, k);
+        return RB;
+    }
+
+    /**
+     * @brief Returns the smallest element no less than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp lower_bound(const _Tp& val) const noexcept {
+        return empty() ? RB
+                       : Base_type::lower_bound(nodes, records, 0, LB, RB, val);
+    }
+
+    /**
+     * @brief Returns the largest element no more than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp upper_bound(const _Tp& val) const noexcept {
+        return empty() ? RB
+                       : Base_type::upper_bound(nodes, records, 0, LB, RB, val);
+    }
+};
+}  // namespace cpdsa
+
+#endif /* CPDSA_ORDERED_SET_VIEW */
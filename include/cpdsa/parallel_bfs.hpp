@@ -0,0 +1,68 @@
+/**
+ * CPDSA: Parallel direction-optimizing BFS -*- C++ -*-
+ *
+ * @file include/cpdsa/src/parallel_bfs.hpp
+ */
+
+#ifndef CPDSA_PARALLEL_BFS
+#define CPDSA_PARALLEL_BFS
+
+#include <thread>
+#include <vector>
+
+#include "base/parallel_bfs_base.hpp"
+#include "csr_graph.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief Returns the number of arcs on a shortest path from @c source to
+ * every vertex of @c graph, or @c UNREACHED, like @c csr_graph::bfs but with
+ * @c threads threads.
+ *
+ * @param incoming The transpose of @c graph (see @c csr_graph::transpose),
+ * through which levels expanded bottom-up look for parents.
+ *
+ * @note Switches each level between top-down and bottom-up expansion,
+ * whichever should look at fewer arcs (see @c parallel_bfs_base). On
+ * low-diameter graphs, the few levels holding most vertices then skip most
+ * of their arcs, so that even one thread is faster than @c csr_graph::bfs.
+ */
+template <typename _Weight>
+[[nodiscard]] std::vector<typename csr_graph<_Weight>::vertex_type>
+parallel_bfs(const csr_graph<_Weight>& graph,
+             typename csr_graph<_Weight>::vertex_type source,
+             const csr_graph<_Weight>& incoming,
+             unsigned threads = std::thread::hardware_concurrency()) {
+    return parallel_bfs_base<csr_graph<_Weight>>(graph, incoming, threads)
+        .search(source);
+}
+
+/**
+ * @brief Same as above, building the transpose of @c graph first, in
+ * @a O(n + m). To run several searches, build it once and pass it instead.
+ */
+template <typename _Weight>
+[[nodiscard]] std::vector<typename csr_graph<_Weight>::vertex_type>
+parallel_bfs(const csr_graph<_Weight>& graph,
+             typename csr_graph<_Weight>::vertex_type source,
+             unsigned threads = std::thread::hardware_concurrency()) {
+    return parallel_bfs(graph, source, graph.transpose(), threads);
+}
+
+/**
+ * @brief Same as above, for an undirected @c graph (built with
+ * @c undirected set), which is its own transpose.
+ */
+template <typename _Weight>
+[[nodiscard]] std::vector<typename csr_graph<_Weight>::vertex_type>
+parallel_bfs_undirected(
+    const csr_graph<_Weight>& graph,
+    typename csr_graph<_Weight>::vertex_type source,
+    unsigned threads = std::thread::hardware_concurrency()) {
+    return parallel_bfs(graph, source, graph, threads);
+}
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_PARALLEL_BFS */
@@ -0,0 +1,230 @@
+/**
+ * CPDSA: Persistent ordered set -*- C++ -*-
+ *
+ * @file include/cpdsa/src/persistent_ordered_set.hpp
+ */
+
+#ifndef CPDSA_PERSISTENT_ORDERED_SET
+#define CPDSA_PERSISTENT_ORDERED_SET
+
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "base/persistent_ordered_set_base.hpp"
+
+namespace cpdsa {
+/**
+ * @brief An @c ordered_set remembering every state it has ever been in.
+ *
+ * @tparam _Tp Type of element. Must be discrete (i.e. @c std::integral<_Tp>
+ * must holds true).
+ * @tparam LB The smallest value allowed to be added.
+ * @tparam RB One past the largest value allowed to be added.
+ *
+ * @note Each @c insert, @c erase_once or @c erase_all creates a new version
+ * out of an existing one, copying only the @a O(log(X)) nodes on the path to
+ * the updated value (where @a X = @a RB - @a LB) and sharing the rest.
+ * Versions are plain numbers: version 0 is the empty set and version @a i is
+ * the result of the @a i-th update. Queries take the version they look at as
+ * their first argument.
+ *
+ * @note Queries taking two versions @a hi and @a lo look at the elements of
+ * @a hi that are not in @a lo, which only makes sense when @a lo is an
+ * ancestor of @a hi reached through insertions only (e.g. "the elements
+ * inserted by updates @a lo + 1 to @a hi").
+ */
+template <std::integral _Tp,
+          _Tp LB = std::numeric_limits<_Tp>::min(),
+          _Tp RB = std::numeric_limits<_Tp>::max()>
+class persistent_ordered_set
+    : private persistent_ordered_set_base<_Tp, LB, RB> {
+   private:
+    using Base_type = persistent_ordered_set_base<_Tp, LB, RB>;
+    using index_type = typename Base_type::index_type;
+
+    std::vector<index_type> roots;
+
+    size_t apply(size_t version, const _Tp& val, int action) {
+        roots.push_back(
+            Base_type::update(roots[version], LB, RB, val, action));
+        return roots.size() - 1;
+    }
+
+   public:
+    using version_type = size_t;
+
+    /**
+     * @brief Create a persistent_ordered_set whose only version is the empty
+     * set.
+     */
+    persistent_ordered_set() : roots(1, Base_type::NULL_NODE) {}
+
+    /**
+     * @brief Returns one past the largest number allowed to be added.
+     */
+    [[nodiscard]] constexpr _Tp end() const noexcept { return RB; }
+
+    /**
+     * @brief Returns the most recent version.
+     */
+    [[nodiscard]] version_type latest() const noexcept {
+        return roots.size() - 1;
+    }
+
+    /**
+     * @brief Returns the number of elements in a version.
+     */
+    [[nodiscard]] size_t size(version_type version) const noexcept {
+        return this->pool[roots[version]].cnt;
+    }
+
+    /**
+     * @brief Returns true if a version is empty.
+     */
+    [[nodiscard]] bool empty(version_type version) const noexcept {
+        return !size(version);
+    }
+
+    /**
+     * @brief Reserve room for @c updates more updates, so that the node pool
+     * doesn't reallocate along the way.
+     */
+    void reserve(size_t updates) {
+        using unsigned_type = std::make_unsigned_t<_Tp>;
+        unsigned_type width = static_cast<unsigned_type>(RB) -
+                              static_cast<unsigned_type>(LB);
+        size_t depth = 1;
+        for (; width; width >>= 1)
+            ++depth;
+        this->pool.reserve(this->pool.size() + updates * depth);
+        roots.reserve(roots.size() + updates);
+    }
+
+    /**
+     * @brief Add a new element into a version.
+     *
+     * @param version The version to start from.
+     * @param val Value to be added.
+     *
+     * @return The newly created version.
+     */
+    version_type insert(version_type version, const _Tp& val) {
+        return apply(version, val, Base_type::NODE_UPDATE_ACTIONS::ADD_ONCE);
+    }
+
+    /**
+     * @brief Add a new element into the latest version.
+     */
+    version_type insert(const _Tp& val) { return insert(latest(), val); }
+
+    /**
+     * @brief Remove one occurence of `val` from a version.
+     *
+     * @return The newly created version.
+     */
+    version_type erase_once(version_type version, const _Tp& val) {
+        return apply(version, val,
+                     Base_type::NODE_UPDATE_ACTIONS::REMOVE_ONCE);
+    }
+
+    /**
+     * @brief Remove one occurence of `val` from the latest version.
+     */
+    version_type erase_once(const _Tp& val) {
+        return erase_once(latest(), val);
+    }
+
+    /**
+     * @brief Remove all occurences of `val` from a version.
+     *
+     * @return The newly created version.
+     */
+    version_type erase_all(version_type version, const _Tp& val) {
+        return apply(version, val, Base_type::NODE_UPDATE_ACTIONS::REMOVE_ALL);
+    }
+
+    /**
+     * @brief Remove all occurences of `val` from the latest version.
+     */
+    version_type erase_all(const _Tp& val) { return erase_all(latest(), val); }
+
+    /**
+     * @brief Forget every version but the (empty) version 0.
+     */
+    void clear() {
+        this->reset();
+        roots.assign(1, Base_type::NULL_NODE);
+    }
+
+    /**
+     * @brief Returns the number of elements of a version in the range `[l,r]`.
+     */
+    [[nodiscard]] int count(version_type version, _Tp l, _Tp r) const {
+        return Base_type::get(roots[version], Base_type::NULL_NODE, LB, RB, l,
+                              r);
+    }
+
+    /**
+     * @brief Returns the number of elements in the range `[l,r]` that are in
+     * version @c hi but not in version @c lo.
+     */
+    [[nodiscard]] int count(version_type hi,
+                            version_type lo,
+                            _Tp l,
+                            _Tp r) const {
+        return Base_type::get(roots[hi], roots[lo], LB, RB, l, r);
+    }
+
+    /**
+     * @brief Returns the number of elements of a version less than or equal
+     * to @c val.
+     */
+    [[nodiscard]] int order_of_key(version_type version, const _Tp& val) const {
+        return count(version, LB, val);
+    }
+
+    /**
+     * @brief Returns the k-th (1-based) smallest element of a version.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp find_by_order(version_type version,
+                                    const size_t& k) const {
+        return Base_type::k_largest(roots[version], Base_type::NULL_NODE, LB,
+                                    RB, k);
+    }
+
+    /**
+     * @brief Returns the k-th (1-based) smallest element among the ones in
+     * version @c hi but not in version @c lo.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp find_by_order(version_type hi,
+                                    version_type lo,
+                                    const size_t& k) const {
+        return Base_type::k_largest(roots[hi], roots[lo], LB, RB, k);
+    }
+
+    /**
+     * @brief Returns the smallest value in a version no less than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp lower_bound(version_type version, const _Tp& val) const {
+        return Base_type::lower_bound(roots[version], LB, RB, val);
+    }
+
+    /**
+     * @brief Returns the largest value in a version no more than @c val.
+     *
+     * @return Either said value or RB if no such value exists.
+     */
+    [[nodiscard]] _Tp upper_bound(version_type version, const _Tp& val) const {
+        return Base_type::upper_bound(roots[version], LB, RB, val);
+    }
+};
+}  // namespace cpdsa
+
+#endif /* CPDSA_PERSISTENT_ORDERED_SET */
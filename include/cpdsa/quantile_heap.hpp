@@ -0,0 +1,394 @@
+/**
+ * CPDSA: Quantile heap implementation -*- C++ -*-
+ *
+ * @file include/cpdsa/src/quantile_heap.hpp
+ */
+
+#ifndef CPDSA_QUANTILE_HEAP
+#define CPDSA_QUANTILE_HEAP
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <initializer_list>
+#include <ratio>
+#include <vector>
+
+#include "base/quantile_heap_base.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief Returns the 1-based rank of the @c num / @c den quantile of @c n
+ * elements, i.e. @a ceil(n * num / den) but at least 1.
+ */
+inline std::size_t quantile_rank(std::size_t n,
+                                 unsigned long long num,
+                                 unsigned long long den) {
+    unsigned long long rank = (n * num + den - 1) / den;
+    return n == 0 ? 0 : rank ? static_cast<std::size_t>(rank) : 1;
+}
+
+/**
+ * @brief Quantiles given as doubles are rounded to this many parts, so that
+ * e.g. 0.99 is exactly 99/100.
+ */
+const unsigned long long QUANTILE_DENOMINATOR = 1000000;
+
+/**
+ * @brief Returns @c q in parts of @c QUANTILE_DENOMINATOR, clamped to
+ * `[0, 1]` (NaN being 0).
+ */
+inline unsigned long long quantile_numerator(double q) {
+    q = q > 0 ? (q < 1 ? q : 1) : 0;
+    return static_cast<unsigned long long>(
+        std::llround(q * QUANTILE_DENOMINATOR));
+}
+
+/**
+ * @brief A standard container automatically maintaining one of its
+ * quantiles.
+ *
+ * @tparam _Tp Type of element.
+ * @tparam _Ratio The quantile, used when none is given at construction.
+ * @tparam _Arity Number of children of every heap node.
+ *
+ * @note Same two heaps as @c median_heap, except that @c lower_heap holds the
+ * @a ceil(q * n) smallest elements (at least one) instead of half of them.
+ * The discrete @a q-quantile is thus the largest element of @c lower_heap:
+ * @c push, @c pop and @c erase take @a O(log(n)) and @c quantile() is
+ * @a O(1). The 0.5-quantile is the discrete median.
+ */
+template <typename _Tp,
+          typename _Ratio = std::ratio<1, 2>,
+          std::size_t _Arity = 4>
+class quantile_heap : private quantile_heap_base<_Tp, _Arity> {
+   private:
+    static_assert(_Ratio::num >= 0 && _Ratio::num <= _Ratio::den,
+                  "quantile must be within [0, 1]");
+    static_assert(is_lazily_erasable<_Tp>::value,
+                  "quantile heap element must have std::hash and == operator");
+
+    typedef _Tp value_type;
+    typedef const _Tp& const_reference;
+
+    typedef quantile_heap_base<_Tp, _Arity> Base_type;
+
+    unsigned long long num, den;  // the quantile is num / den
+
+    void balance() { Base_type::balance(quantile_rank(size(), num, den)); }
+
+   public:
+    /**
+     *  @brief Creates a quantile_heap for the quantile @a _Ratio.
+     */
+    quantile_heap() : num(_Ratio::num), den(_Ratio::den) {}
+
+    /**
+     *  @brief Creates a quantile_heap for the quantile @c q, within `[0, 1]`
+     *  (others are clamped to it).
+     */
+    explicit quantile_heap(double q)
+        : num(quantile_numerator(q)), den(QUANTILE_DENOMINATOR) {}
+
+    /**
+     *  @brief Replace the contents of the container with `[first, last)`, in
+     *  @a O(n) (see @c median_heap::assign).
+     */
+    template <typename _InputIt>
+    void assign(_InputIt first, _InputIt last) {
+        std::vector<value_type> values(first, last);
+        Base_type::assign(values, quantile_rank(values.size(), num, den));
+    }
+
+    /**
+     *  @brief Preallocate both heaps for @c n elements.
+     */
+    void reserve(std::size_t n) {
+        const std::size_t lower = quantile_rank(n, num, den);
+        Base_type::reserve(lower + 1, n - lower + 1);
+    }
+
+    /**
+     *  @brief Add data to the container.
+     *  @param x Data to be added.
+     */
+    void push(const value_type& x) {
+        Base_type::insert(x);
+        balance();
+    }
+
+    /**
+     *  @brief Remove the discrete quantile of the container.
+     */
+    void pop() {
+        Base_type::pop_lower();
+        balance();
+    }
+
+    /**
+     *  @brief Remove one occurence of @c x from the container, which must
+     *  hold it.
+     */
+    void erase(const value_type& x) {
+        Base_type::remove(x);
+        balance();
+    }
+
+    /**
+     *  @brief Remove all elements from the container.
+     */
+    void clear() { this->reset(); }
+
+    /**
+     *  @return The number of elements in the container.
+     */
+    [[nodiscard]] std::size_t size() const {
+        return this->lower_size + this->higher_size;
+    }
+
+    /**
+     *  @return @a true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const { return !size(); }
+
+    /**
+     * @return The quantile maintained, as a fraction.
+     */
+    [[nodiscard]] double ratio() const {
+        return static_cast<double>(num) / den;
+    }
+
+    /**
+     * @return The discrete quantile (with a container of size @a n, its
+     * @a ceil(q * n)-th smallest element) of the container.
+     */
+    [[nodiscard]] const_reference quantile() const {
+        return this->lower_heap.top();
+    }
+};
+
+/**
+ * @brief A standard container automatically maintaining several of its
+ * quantiles at once.
+ *
+ * @tparam _Tp Type of element.
+ * @tparam _Arity Number of children of every heap node.
+ *
+ * @note For quantiles @a q_1 <= ... <= @a q_m, elements are split into
+ * @a m + 1 consecutive segments, segment @a i holding the elements ranked
+ * from @a ceil(q_(i-1) * n) + 1 to @a ceil(q_i * n). The first segment is a
+ * max-heap and the last one a min-heap, as in @c quantile_heap; those in
+ * between need both ends so they are @c interval_heap. All are flat arrays,
+ * so the pool takes no more memory than its elements, and a @c push moves at
+ * most one element across each boundary, i.e. @a O(m log(n)).
+ */
+template <typename _Tp, std::size_t _Arity = 4>
+class quantile_pool {
+   private:
+    typedef _Tp value_type;
+    typedef const _Tp& const_reference;
+
+    std::vector<unsigned long long> nums;  // sorted, over QUANTILE_DENOMINATOR
+    std::vector<std::size_t> order;        // where each quantile was given
+
+    d_ary_heap<value_type, std::less<value_type>, _Arity> first;
+    // segments 1 to m - 1
+    std::vector<interval_heap<value_type, _Arity> > middle;
+    d_ary_heap<value_type, std::greater<value_type>, _Arity> last;
+    std::size_t total;
+
+    [[nodiscard]] std::size_t size_of(std::size_t i) const {
+        return i == 0              ? first.size()
+               : i == nums.size() ? last.size()
+                                  : middle[i - 1].size();
+    }
+
+    [[nodiscard]] const_reference max_of(std::size_t i) const {
+        return i == 0 ? first.top() : middle[i - 1].max();
+    }
+
+    [[nodiscard]] const_reference min_of(std::size_t i) const {
+        return i == nums.size() ? last.top() : middle[i - 1].min();
+    }
+
+    void insert_into(std::size_t i, const value_type& x) {
+        if (i == 0)
+            first.push(x);
+        else if (i == nums.size())
+            last.push(x);
+        else
+            middle[i - 1].push(x);
+    }
+
+    void pop_max(std::size_t i) {
+        if (i == 0)
+            first.pop();
+        else
+            middle[i - 1].pop_max();
+    }
+
+    void pop_min(std::size_t i) {
+        if (i == nums.size())
+            last.pop();
+        else
+            middle[i - 1].pop_min();
+    }
+
+    // push x into segment i (not the first) and pop its smallest element
+    [[nodiscard]] value_type push_pop_min(std::size_t i, const value_type& x) {
+        return i == nums.size() ? last.push_pop(x)
+                                : middle[i - 1].push_pop_min(x);
+    }
+
+    // push x into segment i (not the last) and pop its largest element
+    [[nodiscard]] value_type push_pop_max(std::size_t i, const value_type& x) {
+        return i == 0 ? first.push_pop(x) : middle[i - 1].push_pop_max(x);
+    }
+
+    /**
+     * @brief Move elements across every boundary until each segment has the
+     * size its quantiles call for.
+     */
+    void balance() {
+        std::size_t below = 0;  // elements in the segments before i
+        for (std::size_t i = 0; i < nums.size(); ++i) {
+            const std::size_t target =
+                quantile_rank(total, nums[i], QUANTILE_DENOMINATOR);
+            while (below + size_of(i) > target) {
+                value_type x = max_of(i);
+                pop_max(i);
+                insert_into(i + 1, x);
+            }
+            while (below + size_of(i) < target) {
+                std::size_t j = i + 1;
+                while (!size_of(j))
+                    ++j;
+                value_type x = min_of(j);
+                pop_min(j);
+                insert_into(i, x);
+            }
+            below += size_of(i);
+        }
+    }
+
+   public:
+    /**
+     *  @brief Creates a quantile_pool maintaining every quantile of
+     *  `[q_first, q_last)`, each within `[0, 1]` (others are clamped to it).
+     */
+    template <typename _InputIt>
+    quantile_pool(_InputIt q_first, _InputIt q_last) : total(0) {
+        std::vector<unsigned long long> qs;
+        for (; q_first != q_last; ++q_first)
+            qs.push_back(quantile_numerator(*q_first));
+        order.resize(qs.size());
+        for (std::size_t i = 0; i < qs.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(),
+                  [&](std::size_t a, std::size_t b) { return qs[a] < qs[b]; });
+        for (std::size_t i = 0; i < qs.size(); ++i)
+            nums.push_back(qs[order[i]]);
+        // order[i] becomes the sorted position of the i-th quantile given
+        std::vector<std::size_t> position(qs.size());
+        for (std::size_t i = 0; i < qs.size(); ++i)
+            position[order[i]] = i;
+        order.swap(position);
+        middle.resize(nums.empty() ? 0 : nums.size() - 1);
+    }
+
+    /**
+     *  @brief Creates a quantile_pool maintaining the given quantiles.
+     */
+    quantile_pool(std::initializer_list<double> qs)
+        : quantile_pool(qs.begin(), qs.end()) {}
+
+    /**
+     *  @brief Preallocate every segment for @c n elements in total.
+     */
+    void reserve(std::size_t n) {
+        std::size_t below = 0;
+        for (std::size_t i = 0; i <= nums.size(); ++i) {
+            const std::size_t upto = i < nums.size()
+                                         ? quantile_rank(n, nums[i],
+                                                         QUANTILE_DENOMINATOR)
+                                         : n;
+            const std::size_t size = upto - below + 1;
+            if (i == 0)
+                first.reserve(size);
+            else if (i == nums.size())
+                last.reserve(size);
+            else
+                middle[i - 1].reserve(size);
+            below = upto;
+        }
+    }
+
+    /**
+     *  @brief  Add data to the container.
+     *  @param x Data to be added.
+     */
+    void push(const value_type& x) {
+        ++total;
+        const std::size_t m = nums.size();
+        std::size_t i = 0, below = 0;  // elements in the segments before i
+        while (i < m && !(size_of(i) && !(max_of(i) < x)))
+            below += size_of(i++);
+        // x belongs to segment i. Rather than inserting it, then moving
+        // elements across the boundaries that are now off by one, the move
+        // is fused with the insertion: if the boundary before i is one short,
+        // the smallest of x and segment i fills it ...
+        value_type v = x;
+        if (i > 0 && below < quantile_rank(total, nums[i - 1],
+                                           QUANTILE_DENOMINATOR)) {
+            v = push_pop_min(i, x);
+            below -= size_of(--i);
+        }
+        // ... and while a segment is full, v takes the place of its largest
+        // element, which goes on to the next one
+        for (; i < m && below + size_of(i) + 1 >
+                            quantile_rank(total, nums[i], QUANTILE_DENOMINATOR);
+             ++i) {
+            below += size_of(i);
+            v = push_pop_max(i, v);
+        }
+        insert_into(i, v);
+        balance();
+    }
+
+    /**
+     *  @brief Remove all elements from the container.
+     */
+    void clear() {
+        first.clear();
+        for (std::size_t i = 0; i < middle.size(); ++i)
+            middle[i].clear();
+        last.clear();
+        total = 0;
+    }
+
+    /**
+     *  @return The number of elements in the container.
+     */
+    [[nodiscard]] std::size_t size() const { return total; }
+
+    /**
+     *  @return @a true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const { return !total; }
+
+    /**
+     * @return The discrete quantile (see @c quantile_heap) for the @c i-th
+     * quantile given at construction.
+     */
+    [[nodiscard]] const_reference quantile(std::size_t i) const {
+        std::size_t j = order[i];
+        while (!size_of(j))  // a segment is empty if q_j * n rounds like q_(j-1)
+            --j;
+        return max_of(j);
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_QUANTILE_HEAP */
@@ -0,0 +1,188 @@
+/**
+ * CPDSA: Mergeable quantile sketch -*- C++ -*-
+ *
+ * @file include/cpdsa/src/quantile_sketch.hpp
+ */
+
+#ifndef CPDSA_QUANTILE_SKETCH
+#define CPDSA_QUANTILE_SKETCH
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "base/quantile_sketch_base.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief An approximate @c median_heap in bounded memory, which can be
+ * merged with others.
+ *
+ * @tparam _Tp Type of element. Must be copyable and ordered by @c <.
+ *
+ * @note A KLL sketch (Karnin, Lang and Liberty, 2016). Whatever the length
+ * @a n of the stream, it holds at most about @a 3k elements, and the rank of
+ * any answer is off by @a O(n / k) with high probability: around 1% of @a n
+ * for the default @a k = 200. @c push is amortized
+ * @a O(log(k)), independent of @a n.
+ *
+ * @note Sketches built separately (e.g. one per thread) with @c merge give
+ * the same guarantees as one sketch fed the concatenated streams.
+ *
+ * @note Queries sort the held elements once, in @a O(k log(k)), and reuse
+ * that until the next update. Since they cache it, even const queries must
+ * not run concurrently on the same sketch.
+ */
+template <typename _Tp>
+class quantile_sketch : private quantile_sketch_base<_Tp> {
+   private:
+    typedef _Tp value_type;
+    typedef quantile_sketch_base<_Tp> Base_type;
+
+    // the held elements sorted, with cumulative weights
+    mutable std::vector<std::pair<_Tp, std::size_t> > sorted;
+    mutable bool sorted_valid;
+
+    const std::vector<std::pair<_Tp, std::size_t> >& view() const {
+        if (!sorted_valid) {
+            sorted = Base_type::weighted();
+            for (std::size_t i = 1; i < sorted.size(); ++i)
+                sorted[i].second += sorted[i - 1].second;
+            sorted_valid = true;
+        }
+        return sorted;
+    }
+
+    /**
+     * @brief Returns the first held element whose cumulative weight reaches
+     * @c target. The sketch must not be empty.
+     */
+    [[nodiscard]] const value_type& at_weight(double target) const {
+        const std::vector<std::pair<_Tp, std::size_t> >& v = view();
+        std::size_t lo = 0, hi = v.size() - 1;
+        while (lo < hi) {
+            std::size_t mid = (lo + hi) / 2;
+            if (v[mid].second < target)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return v[lo].first;
+    }
+
+   public:
+    /**
+     *  @brief Creates a quantile_sketch with no elements.
+     *  @param k Accuracy parameter: memory grows and errors shrink linearly
+     *  with it.
+     */
+    explicit quantile_sketch(std::size_t k = 200)
+        : Base_type(k), sorted_valid(false) {}
+
+    /**
+     *  @brief  Add data to the sketch.
+     *  @param x Data to be added.
+     */
+    void push(const value_type& x) {
+        Base_type::insert(x);
+        sorted_valid = false;
+    }
+
+    /**
+     *  @brief Add every element summarized by @c other to this sketch.
+     */
+    void merge(const quantile_sketch& other) {
+        if (this == &other) {
+            merge(quantile_sketch(other));
+            return;
+        }
+        Base_type::absorb(other);
+        sorted_valid = false;
+    }
+
+    /**
+     *  @brief Remove all elements from the sketch.
+     */
+    void clear() {
+        this->reset();
+        sorted_valid = false;
+    }
+
+    /**
+     *  @return The number of elements pushed into the sketch.
+     */
+    [[nodiscard]] std::size_t size() const { return this->total; }
+
+    /**
+     *  @return @a true if the sketch is empty.
+     */
+    [[nodiscard]] bool empty() const { return !this->total; }
+
+    /**
+     *  @return The number of elements the sketch currently holds.
+     */
+    [[nodiscard]] std::size_t retained() const { return Base_type::retained; }
+
+    /**
+     *  @return The number of bytes held by the sketch.
+     */
+    [[nodiscard]] std::size_t memory_usage() const {
+        std::size_t result = sizeof(*this) + sorted.capacity() *
+                                                 sizeof(sorted[0]);
+        for (std::size_t h = 0; h < this->levels.size(); ++h)
+            result += sizeof(this->levels[h]) +
+                      this->levels[h].capacity() * sizeof(_Tp);
+        return result;
+    }
+
+    /**
+     * @return An estimate of the discrete @a q-quantile (with @a n elements,
+     * the @a ceil(q * n)-th smallest) of the elements pushed. The sketch
+     * must not be empty.
+     */
+    [[nodiscard]] value_type quantile(double q) const {
+        return at_weight(q * view().back().second);
+    }
+
+    /**
+     * @return An estimate of the number of elements pushed less than or
+     * equal to @c x.
+     */
+    [[nodiscard]] std::size_t rank(const value_type& x) const {
+        if (empty())
+            return 0;
+        const std::vector<std::pair<_Tp, std::size_t> >& v = view();
+        std::size_t lo = 0, hi = v.size();  // first element greater than x
+        while (lo < hi) {
+            std::size_t mid = (lo + hi) / 2;
+            if (x < v[mid].first)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return lo ? v[lo - 1].second : 0;
+    }
+
+    /**
+     * @return An estimate of the discrete median (see @c median_heap).
+     */
+    [[nodiscard]] value_type discrete_median() const { return quantile(0.5); }
+
+    /**
+     * @return An estimate of the median, as a double: like
+     * @c median_heap::median, the average of the two middle elements when
+     * there is an even number of them. The sketch must not be empty.
+     */
+    [[nodiscard]] double median() const {
+        const std::size_t n = view().back().second;
+        const double low = static_cast<double>(at_weight((n + 1) / 2));
+        const double high = static_cast<double>(at_weight(n / 2 + 1));
+        return (low + high) / 2;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_QUANTILE_SKETCH */
@@ -8,6 +8,9 @@
 #define CPDSA_SKIP_LIST
 
 #include <concepts>
+#include <cstddef>
+#include <iterator>
+
 #include "./base/skip_list_base.hpp"
 
 namespace cpdsa {
@@ -15,29 +18,210 @@ namespace cpdsa {
 /**
  * @brief Types eligible to be elements of @c skip_list.
  */
-#if __cplusplus >= 202002L
 template <typename _Tp>
-concept Skip_list_element_type = std::three_way_comparable<_Tp>;
-#else
-// shit goes here
-#endif
+concept Skip_list_element_type =
+    std::three_way_comparable<_Tp> && std::semiregular<_Tp>;
 
 /**
  * @brief A container maintaining *unique* elements in increasing order.
+ *
+ * @tparam _Tp Type of element.
+ * @tparam _Levels Maximum height of the skip list.
+ *
+ * @note Elements are stored by value in blocks of 512 bytes (128 ints; see
+ * @c skip_list_base): a lookup goes through about @a log_2(n / B) blocks,
+ * @a B being the number of elements per block, instead of the @a log_2(n)
+ * nodes of a @c std::set. Every operation takes @a O(log(n)) expected
+ * time.
+ *
+ * @note Links also count the elements they skip over, which gives
+ * @c order_of_key and @c find_by_order in @a O(log(n)) for any element type,
+ * with the same meaning as in @c ordered_set.
+ *
+ * @note Elements move between blocks as those split and merge: @c insert and
+ * @c erase invalidate every iterator.
  */
-template <Skip_list_element_type _Tp>
-class skip_list {
-    using iterator = _Tp*;              // stub
-    using const_iterator = const _Tp*;  // another stub
+template <Skip_list_element_type _Tp, std::size_t _Levels = 16>
+class skip_list : private skip_list_base<_Tp, _Levels> {
+   private:
+    using Base_type = skip_list_base<_Tp, _Levels>;
+    using block = typename Base_type::block;
+
+   public:
+    using value_type = _Tp;
+    using size_type = std::size_t;
+
+    /**
+     * @brief Bidirectional iterator over the elements, in increasing order.
+     * Elements cannot be modified through it.
+     */
+    class const_iterator {
+       private:
+        friend class skip_list;
+
+        const skip_list* owner;
+        const block* b;  // null for end()
+        std::uint32_t i;
+
+        const_iterator(const skip_list* owner_, const block* b_,
+                       std::uint32_t i_)
+            : owner(owner_), b(b_), i(i_) {}
+
+       public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = _Tp;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const _Tp*;
+        using reference = const _Tp&;
+
+        const_iterator() : owner(nullptr), b(nullptr), i(0) {}
+
+        reference operator*() const { return b->keys[i]; }
+        pointer operator->() const { return b->keys + i; }
+
+        const_iterator& operator++() {
+            if (++i == b->count) {
+                b = b->next();
+                i = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        const_iterator& operator--() {
+            if (!b) {
+                b = owner->tail;
+                i = b->count;
+            } else if (!i) {
+                b = b->prev;
+                i = b->count;
+            }
+            --i;
+            return *this;
+        }
+
+        const_iterator operator--(int) {
+            const_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return b == other.b && i == other.i;
+        }
+    };
+
+    using iterator = const_iterator;
+
+   private:
+    const_iterator make_iterator(std::pair<block*, std::uint32_t> at) const {
+        return const_iterator(this, at.first, at.second);
+    }
+
+   public:
+    /**
+     * @brief Create an empty skip_list.
+     */
+    skip_list() = default;
+
+    skip_list(skip_list&&) noexcept = default;
+    skip_list& operator=(skip_list&&) noexcept = default;
+
+    /**
+     * @brief Add @c val into the container.
+     *
+     * @return False if it was already there.
+     */
+    bool insert(const _Tp& val) { return Base_type::insert(val); }
+
+    /**
+     * @brief Remove @c val from the container.
+     *
+     * @return False if it wasn't there.
+     */
+    bool erase(const _Tp& val) { return Base_type::erase(val); }
+
+    /**
+     * @brief Remove all elements.
+     */
+    void clear() noexcept { this->reset(); }
+
+    /**
+     * @brief Returns an iterator to @c val, or @c end() if it isn't there.
+     */
+    [[nodiscard]] const_iterator find(const _Tp& val) const {
+        const_iterator it = lower_bound(val);
+        return it != end() && *it == val ? it : end();
+    }
+
+    /**
+     * @brief Returns true if @c val is in the container.
+     */
+    [[nodiscard]] bool contains(const _Tp& val) const {
+        return find(val) != end();
+    }
+
+    /**
+     * @brief Returns an iterator to the first element not less than @c val.
+     */
+    [[nodiscard]] const_iterator lower_bound(const _Tp& val) const {
+        return make_iterator(Base_type::template locate<false>(val));
+    }
+
+    /**
+     * @brief Returns an iterator to the first element greater than @c val.
+     */
+    [[nodiscard]] const_iterator upper_bound(const _Tp& val) const {
+        return make_iterator(Base_type::template locate<true>(val));
+    }
+
+    /**
+     * @brief Returns the number of elements less than or equal to @c val.
+     */
+    [[nodiscard]] size_type order_of_key(const _Tp& val) const {
+        return Base_type::rank_of(val);
+    }
+
+    /**
+     * @brief Returns an iterator to the k-th (1-based) smallest element in
+     * the container, or @c end() if there are fewer than @c k.
+     */
+    [[nodiscard]] const_iterator find_by_order(size_type k) const {
+        return make_iterator(Base_type::select(k));
+    }
+
+    [[nodiscard]] const_iterator begin() const {
+        return const_iterator(this, this->head->next(), 0);
+    }
+
+    [[nodiscard]] const_iterator end() const {
+        return const_iterator(this, nullptr, 0);
+    }
 
-    iterator insert(const _Tp& val) {}
-    iterator erase(const _Tp& val) {}
+    /**
+     * @brief Returns the number of elements in the container.
+     */
+    [[nodiscard]] size_type size() const noexcept { return this->total; }
 
-    [[nodiscard]] iterator find(const _Tp& val) {}
-    iterator begin();
-    iterator end();
+    /**
+     * @brief Returns true if the container is empty.
+     */
+    [[nodiscard]] bool empty() const noexcept { return !size(); }
 
-    void clear() {}
+    /**
+     * @brief Returns the number of bytes allocated for the blocks.
+     */
+    [[nodiscard]] size_type memory_usage() const noexcept {
+        size_type result = Base_type::block_bytes(_Levels);
+        for (const block* b = this->head->next(); b; b = b->next())
+            result += Base_type::block_bytes(b->height);
+        return result;
+    }
 };
 
 }  // namespace cpdsa
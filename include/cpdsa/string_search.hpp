@@ -0,0 +1,83 @@
+/**
+ * CPDSA: Single-pattern string search -*- C++ -*-
+ *
+ * @file include/cpdsa/src/string_search.hpp
+ */
+
+#ifndef CPDSA_STRING_SEARCH
+#define CPDSA_STRING_SEARCH
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "base/string_search_base.hpp"
+
+namespace cpdsa {
+
+/**
+ * @brief A pattern, preprocessed to be searched for in many texts.
+ *
+ * @note Filters candidate positions with SSE2 or AVX2 when available, and
+ * checks them with @c memcmp, falling back to Knuth-Morris-Pratt when that
+ * stops paying off (see @c string_search_base): a search takes @a O(n + m)
+ * in the worst case, and much less than one step per byte in most texts.
+ *
+ * @note Occurrences may overlap. The empty pattern occurs at every position
+ * from 0 to @c text.size(), like for @c std::string_view::find.
+ */
+class string_search : private string_search_base {
+   private:
+    using Base_type = string_search_base;
+
+   public:
+    using size_type = Base_type::size_type;
+
+    static constexpr size_type npos = std::string_view::npos;
+
+    /**
+     * @brief Prepare to search for @c pattern, in @a O(m).
+     */
+    explicit string_search(std::string_view pattern) { this->build(pattern); }
+
+    [[nodiscard]] size_type size() const noexcept {
+        return this->pattern.size();
+    }
+
+    /**
+     * @brief Returns the position of the first occurrence in @c text
+     * starting at or after @c from, or @c npos.
+     */
+    [[nodiscard]] size_type find(std::string_view text,
+                                 size_type from = 0) const {
+        return this->search(text, from, [](size_type) { return true; });
+    }
+
+    /**
+     * @brief Returns the positions of all occurrences in @c text, in order.
+     */
+    [[nodiscard]] std::vector<size_type> find_all(std::string_view text) const {
+        std::vector<size_type> result;
+        this->search(text, 0, [&result](size_type at) {
+            result.push_back(at);
+            return false;
+        });
+        return result;
+    }
+
+    /**
+     * @brief Returns the number of occurrences in @c text.
+     */
+    [[nodiscard]] size_type count(std::string_view text) const {
+        size_type result = 0;
+        this->search(text, 0, [&result](size_type) {
+            ++result;
+            return false;
+        });
+        return result;
+    }
+};
+
+}  // namespace cpdsa
+
+#endif /* CPDSA_STRING_SEARCH */
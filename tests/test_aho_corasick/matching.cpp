@@ -0,0 +1,200 @@
+/**
+ * CPDSA: Aho-Corasick matching test and benchmark -*- C++ -*-
+ *
+ * @file tests/test_aho_corasick/matching.cpp
+ *
+ * Checks aho_corasick against std::string::find on random patterns and
+ * texts, fed whole, in pieces and from a file. Then times counting the
+ * occurrences of 10^5 patterns in 2^24 bytes of log-like text with:
+ *  - an Aho-Corasick automaton over a pointer-based trie with failure links
+ *  - cpdsa::aho_corasick
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+string random_string(int n, string_view alphabet) {
+    string s(n, 0);
+    for (auto& c : s)
+        c = alphabet[rand(0, alphabet.size() - 1)];
+    return s;
+}
+
+using matches = vector<pair<uint32_t, size_t>>;
+
+matches naive_matches(const vector<string>& patterns, const string& text) {
+    matches result;
+    for (uint32_t p = 0; p < patterns.size(); ++p)
+        for (size_t at = text.find(patterns[p]); at != string::npos;
+             at = text.find(patterns[p], at + 1))
+            result.push_back({p, at + patterns[p].size()});
+    sort(result.begin(), result.end());
+    return result;
+}
+
+void random_dictionaries(int count, int max_length, int text_length,
+                         string_view alphabet) {
+    vector<string> patterns(count);
+    for (auto& p : patterns)
+        p = random_string(rand(1, max_length), alphabet);
+    patterns.push_back(patterns[0]);  // a duplicate
+    string text = random_string(text_length, alphabet) + patterns[1];
+    cpdsa::aho_corasick ac(patterns);
+    assert(ac.pattern_count() == patterns.size());
+    auto expected = naive_matches(patterns, text);
+
+    matches found;
+    auto record = [&](uint32_t p, size_t end) { found.push_back({p, end}); };
+    auto state = ac.feed(text, ac.START, record);
+    sort(found.begin(), found.end());
+    assert(found == expected && ac.count(text) == expected.size());
+
+    // in pieces, offsetting the ends of later ones
+    found.clear();
+    state = ac.START;
+    for (size_t at = 0; at < text.size();) {
+        size_t len = min<size_t>(rand(0, 7), text.size() - at);
+        state = ac.feed(string_view(text).substr(at, len), state,
+                        [&](uint32_t p, size_t end) {
+                            found.push_back({p, at + end});
+                        });
+        at += len;
+    }
+    sort(found.begin(), found.end());
+    assert(found == expected);
+
+    const char* path = "test_aho_corasick.in";
+    FILE* f = fopen(path, "wb");
+    fwrite(text.data(), 1, text.size(), f);
+    fclose(f);
+    f = fopen(path, "rb");
+    found.clear();
+    assert(ac.scan(record, f) == text.size());
+    fclose(f);
+    remove(path);
+    sort(found.begin(), found.end());
+    assert(found == expected);
+}
+
+void special_bytes() {
+    vector<string> patterns = {string("a\0b", 3), "\xff\xfe", "\n"};
+    cpdsa::aho_corasick ac(patterns);
+    string text = string("xa\0b\xff\xfe\n\na\0", 10);
+    assert(ac.count(text) == 4);
+    assert(ac.count("no match here") == 0);
+
+    // every byte value, so that no byte is left for the "others" class
+    patterns.clear();
+    for (int c = 0; c < 256; ++c)
+        patterns.push_back(string(1, char(c)));
+    patterns.push_back("\xff");
+    cpdsa::aho_corasick all(patterns);
+    assert(all.count("\xff") == 2 && all.count("\x01") == 1);
+    assert(all.count(string("\0\xfe", 2)) == 2);
+
+    bool thrown = false;
+    try {
+        cpdsa::aho_corasick bad(vector<string>{"a", ""});
+    } catch (const invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+struct pointer_trie {
+    struct node {
+        map<char, node*> next;
+        node* fail = nullptr;
+        size_t matches = 0;  // ending here or at a suffix
+    };
+    deque<node> nodes;
+    node* root;
+
+    explicit pointer_trie(const vector<string>& patterns) {
+        root = &nodes.emplace_back();
+        for (auto& p : patterns) {
+            node* v = root;
+            for (char c : p) {
+                auto& child = v->next[c];
+                if (!child)
+                    child = &nodes.emplace_back();
+                v = child;
+            }
+            ++v->matches;
+        }
+        queue<node*> q;
+        root->fail = root;
+        for (q.push(root); !q.empty(); q.pop()) {
+            node* v = q.front();
+            for (auto [c, u] : v->next) {
+                node* f = v->fail;
+                while (f != root && !f->next.count(c))
+                    f = f->fail;
+                u->fail = v != root && f->next.count(c) ? f->next[c] : root;
+                u->matches += u->fail->matches;
+                q.push(u);
+            }
+        }
+    }
+
+    size_t count(const string& text) const {
+        size_t result = 0;
+        node* v = root;
+        for (char c : text) {
+            while (v != root && !v->next.count(c))
+                v = v->fail;
+            auto it = v->next.find(c);
+            v = it == v->next.end() ? root : it->second;
+            result += v->matches;
+        }
+        return result;
+    }
+};
+
+int32_t main() {
+    random_dictionaries(1, 1, 10, "a");
+    random_dictionaries(5, 3, 1000, "ab");
+    random_dictionaries(50, 6, 5000, "abc");
+    random_dictionaries(300, 12, 20000, "abcdefghijklmnopqrstuvwxyz");
+    random_dictionaries(1000, 4, 20000, "0123456789 .-:");
+    special_bytes();
+
+    // patterns drawn from the text, so that they occur
+    constexpr int k = 100000, n = 1 << 24;
+    const string_view alphabet = "abcdefghijklmnopqrstuvwxyz0123456789 :-./=[]";
+    string text = random_string(n, alphabet.substr(0, 30));
+    for (int i = 0; i < n; i += rand(40, 120))
+        text[i] = '\n';
+    vector<string> patterns(k);
+    for (auto& p : patterns) {
+        int len = rand(6, 24);
+        p = rand(0, 1) ? text.substr(rand(0, n - len), len)
+                       : random_string(len, alphabet);
+    }
+
+    auto start1 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    pointer_trie trie(patterns);
+    auto start2 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    size_t trie_count = trie.count(text);
+    auto start3 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::aho_corasick ac(patterns);
+    auto start4 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    size_t ac_count = ac.count(text);
+    auto start5 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(trie_count == ac_count);
+
+    auto trie_scan = (start3 - start2) / 1e6, ac_scan = (start5 - start4) / 1e6;
+    printf("With %d patterns (%zu states) and %d bytes of text:\n", k,
+           ac.state_count(), n);
+    printf("build: pointer trie %.5f ms, cpdsa::aho_corasick %.5f ms\n",
+           (start2 - start1) / 1e6, (start4 - start3) / 1e6);
+    printf("count: pointer trie %.5f ms, cpdsa::aho_corasick %.5f ms "
+           "(%.5fx faster, %.2f MB/s)\n\n",
+           trie_scan, ac_scan, trie_scan / ac_scan, n / ac_scan / 1e3);
+}
@@ -0,0 +1,201 @@
+/**
+ * CPDSA: bigint tests and benchmark -*- C++ -*-
+ *
+ * @file tests/test_bigint/arithmetic.cpp
+ *
+ * Checks bigint against __int128 on small values, its multiplications of
+ * every size against a quadratic reference, the division identity and
+ * decimal round trips, and reading through buffer_scan. Then times parsing,
+ * multiplying, dividing and printing numbers of 10^6 digits.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+using cpdsa::bigint;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+long long rand(long long l, long long r) {
+    return uniform_int_distribution<long long>(l, r)(rng);
+}
+
+string random_digits(size_t n) {
+    string s(n, '0');
+    for (auto& c : s)
+        c = '0' + rand(0, 9);
+    s[0] = '1' + rand(0, 8);
+    return s;
+}
+
+bigint random_bigint(size_t digits) {
+    bigint x(random_digits(digits));
+    return rand(0, 1) ? -x : x;
+}
+
+string to_string_128(__int128 x) {
+    if (!x)
+        return "0";
+    string s;
+    bool negative = x < 0;
+    for (; x; x /= 10)
+        s += '0' + abs((int)(x % 10));
+    if (negative)
+        s += '-';
+    return string(s.rbegin(), s.rend());
+}
+
+// a * b one 19-digit chunk of b at a time, so only through 1-limb products
+bigint reference_product(const bigint& a, const bigint& b) {
+    string digits = b.to_string();
+    bool negative = digits[0] == '-';
+    if (negative)
+        digits.erase(digits.begin());
+    bigint result, ten19(10000000000000000000ull);
+    size_t first = (digits.size() - 1) % 19 + 1;
+    for (size_t i = 0; i < digits.size(); i = i ? i + 19 : first)
+        result = result * ten19 +
+                 a * bigint(stoull(digits.substr(i, i ? 19 : first)));
+    return negative ? -result : result;
+}
+
+// Horner's rule over 19-digit chunks
+bigint reference_parse(const string& digits) {
+    bigint result, ten19(10000000000000000000ull);
+    size_t first = (digits.size() - 1) % 19 + 1;
+    for (size_t i = 0; i < digits.size(); i = i ? i + 19 : first)
+        result = result * ten19 + bigint(stoull(digits.substr(i, i ? 19 : first)));
+    return result;
+}
+
+void small_values() {
+    for (int it = 0; it < 1 << 16; ++it) {
+        long long a = rand(LLONG_MIN, LLONG_MAX), b = rand(LLONG_MIN, LLONG_MAX);
+        if (it % 4 == 0)
+            b = rand(-1000, 1000);
+        bigint x(a), y(b);
+        assert((x + y).to_string() == to_string_128((__int128)a + b));
+        assert((x - y).to_string() == to_string_128((__int128)a - b));
+        assert((x * y).to_string() == to_string_128((__int128)a * b));
+        if (b) {
+            assert((x / y).to_string() == to_string_128((__int128)a / b));
+            assert((x % y).to_string() == to_string_128((__int128)a % b));
+        }
+        assert((x < y) == (a < b) && (x == y) == (a == b));
+        assert(bigint(to_string(a)) == x);
+    }
+    assert(bigint(LLONG_MIN).to_string() == to_string(LLONG_MIN));
+    assert(bigint(ULLONG_MAX).to_string() == to_string(ULLONG_MAX));
+    assert(bigint("-0") == bigint() && (-bigint()).to_string() == "0");
+    assert(bigint("+000123") == 123 && !bigint("0000"));
+}
+
+void products() {
+    // sizes in limbs around the thresholds of every algorithm
+    vector<size_t> sizes = {1, 2, 31, 32, 33, 64, 100, 500, 2000, 4095, 4096, 6000};
+    for (size_t n : sizes)
+        for (size_t m : sizes) {
+            if (m > n)
+                continue;
+            bigint a = random_bigint(n * 19 + rand(0, 18));
+            bigint b = random_bigint(m * 19 + rand(0, 18));
+            assert(a * b == reference_product(a, b));
+            assert(a * a == reference_product(a, a));
+        }
+    // all nines stress carries
+    for (size_t n : {40, 2000, 40000}) {
+        bigint nines(string(n, '9')), power(string("1") + string(n, '0'));
+        assert(nines * nines == power * power - power - power + 1);
+    }
+}
+
+void divisions() {
+    vector<size_t> digits = {1, 19, 20, 200, 1300, 1400, 5000, 30000};
+    for (size_t n : digits)
+        for (size_t m : digits) {
+            if (m > n)
+                continue;
+            for (int it = 0; it < 3; ++it) {
+                bigint a = random_bigint(n), b = random_bigint(m);
+                bigint q = a / b, r = a % b;
+                assert(q * b + r == a);
+                assert((r < 0 ? -r : r) < (b < 0 ? -b : b));
+                assert(!r || (r < 0) == (a < 0));
+                // a remainder with the sign of a * b keeps the quotient
+                bigint rem = (r < 0 ? -r : r) * ((a < 0) != (b < 0) ? -1 : 1);
+                bigint c = a * b + rem;
+                assert(c / b == a && c % b == rem);
+            }
+        }
+}
+
+void conversions() {
+    for (size_t n : {1, 18, 19, 20, 38, 607, 608, 609, 5000, 20000}) {
+        string s = random_digits(n);
+        assert(bigint(s) == reference_parse(s));
+        assert(bigint(s).to_string() == s);
+        assert(bigint("-" + s).to_string() == "-" + s);
+    }
+    for (size_t n : {100000, 300000}) {
+        string s = random_digits(n);
+        assert(bigint(s).to_string() == s);
+    }
+    // zeros in the middle, where a padded half is all zeros
+    string s(80002, '0');
+    s[0] = s[50001] = '1';
+    assert(bigint(s).to_string() == s);
+}
+
+void scanning() {
+    string big = random_digits(50000);
+    const char* path = "test_bigint.in";
+    FILE* f = fopen(path, "w");
+    fprintf(f, "  -%s x 42\n+7 000123\n-9", big.c_str());
+    fclose(f);
+    assert(freopen(path, "r", stdin));
+    bigint a, b, c;
+    int n, m;
+    cpdsa::buffer_scan(a, n, b, c, m);
+    assert(a == -bigint(big) && n == 42 && b == 7 && c == 123 && m == -9);
+    remove(path);
+}
+
+int32_t main() {
+    small_values();
+    products();
+    divisions();
+    conversions();
+    scanning();
+
+    constexpr int n = 1000000;
+    string s = random_digits(n), t = random_digits(n);
+
+    auto start1 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    bigint a(s), b(t);
+    auto start2 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    bigint c = a * b;
+    auto start3 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    bigint q = c / b;
+    auto start4 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    string printed = c.to_string();
+    auto start5 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(q == a && printed.size() >= 2 * n - 1);
+
+    constexpr int m = 100000;
+    bigint x(random_digits(m)), y(random_digits(m));
+    auto start6 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    bigint fast = x * y;
+    auto start7 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    bigint slow = reference_product(x, y);
+    auto start8 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(fast == slow);
+
+    printf("With two numbers of %d digits:\n", n);
+    printf("parse both: %.5f ms\n", (start2 - start1) / 1e6);
+    printf("multiply  : %.5f ms\n", (start3 - start2) / 1e6);
+    printf("divide    : %.5f ms\n", (start4 - start3) / 1e6);
+    printf("print     : %.5f ms\n\n", (start5 - start4) / 1e6);
+    printf("With two numbers of %d digits:\n", m);
+    printf("multiply: bigint %.5f ms, quadratic %.5f ms (%.5fx slower)\n\n",
+           (start7 - start6) / 1e6, (start8 - start7) / 1e6,
+           (double)(start8 - start7) / (start7 - start6));
+}
@@ -0,0 +1,66 @@
+/**
+ * CPDSA: Concurrent ordered set throughput benchmark -*- C++ -*-
+ *
+ * @file tests/test_concurrent_ordered_set/throughput.cpp
+ *
+ * Inserts 2^20 random integers from 1, 2, 4, ... threads into:
+ *  - cpdsa::ordered_set behind one global std::mutex
+ *  - cpdsa::concurrent_ordered_set
+ * then validates the final contents of both.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+constexpr int n = 1 << 20;
+
+static int v[n];
+
+template <typename Inserter>
+double timed_inserts(int threads, Inserter&& insert) {
+    auto start = chrono::high_resolution_clock::now().time_since_epoch().count();
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            for (int i = t; i < n; i += threads)
+                insert(v[i]);
+        });
+    for (auto& th : pool)
+        th.join();
+    auto stop = chrono::high_resolution_clock::now().time_since_epoch().count();
+    return (stop - start) / 1e6;
+}
+
+int32_t main() {
+    mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+    for (int i = 0; i < n; ++i)
+        v[i] = uniform_int_distribution<int>((int)-1e9, (int)1e9)(rng);
+
+    const int max_threads = max(1u, thread::hardware_concurrency());
+    printf("With n = %d:\n", n);
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        mutex global_mutex;
+        cpdsa::ordered_set<int> locked;
+        cpdsa::concurrent_ordered_set<int> sharded;
+
+        auto locked_time = timed_inserts(threads, [&](int x) {
+            lock_guard<mutex> lock(global_mutex);
+            locked.insert(x);
+        });
+        auto sharded_time =
+            timed_inserts(threads, [&](int x) { sharded.insert(x); });
+
+        assert(locked.size() == (size_t)n && sharded.size() == (size_t)n);
+        for (int k = 1; k <= n; k += n / 64)
+            assert(locked.find_by_order(k) == sharded.find_by_order(k));
+        for (int i = 0; i < 64; ++i)
+            assert((size_t)locked.order_of_key(v[i]) ==
+                   sharded.order_of_key(v[i]));
+
+        printf("%2d thread(s): global mutex %.5f ms, sharded %.5f ms "
+               "(%.5fx faster, %.2f Minserts/s)\n",
+               threads, locked_time, sharded_time, locked_time / sharded_time,
+               n / sharded_time / 1e3);
+    }
+}
@@ -0,0 +1,149 @@
+/**
+ * CPDSA: Concurrent skip list throughput benchmark -*- C++ -*-
+ *
+ * @file tests/test_concurrent_skip_list/throughput.cpp
+ *
+ * First hammers a small key range from every thread with inserts and erases,
+ * and checks that the final contents match the successful operations. Then,
+ * from 1, 2, 4, ... threads, runs 2^22 operations (80% lookups, 10% inserts,
+ * 10% erases) over 2^20 keys, half of them present, on:
+ *  - std::set behind one global std::mutex
+ *  - std::set behind one std::shared_mutex, lookups sharing it
+ *  - cpdsa::concurrent_skip_list
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+constexpr int keys = 1 << 20, ops = 1 << 22;
+
+static int op_key[ops], op_type[ops];
+
+template <typename Operation>
+double timed_ops(int threads, Operation&& operation) {
+    auto start = chrono::high_resolution_clock::now().time_since_epoch().count();
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            for (int i = t; i < ops; i += threads)
+                operation(op_type[i], op_key[i]);
+        });
+    for (auto& th : pool)
+        th.join();
+    auto stop = chrono::high_resolution_clock::now().time_since_epoch().count();
+    return (stop - start) / 1e6;
+}
+
+void contended_operations(int threads, int range, int rounds) {
+    cpdsa::concurrent_skip_list<int> sl;
+    vector<atomic<int>> net(range);
+    vector<thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            mt19937 rng(t);
+            for (int i = 0; i < rounds; ++i) {
+                int x = rng() % range;
+                if (rng() % 2) {
+                    if (sl.insert(x))
+                        ++net[x];
+                } else if (sl.erase(x)) {
+                    --net[x];
+                }
+                (void)sl.lower_bound(x);
+            }
+        });
+    for (auto& th : pool)
+        th.join();
+    size_t expected = 0;
+    for (int x = 0; x < range; ++x) {
+        assert(net[x] == 0 || net[x] == 1);
+        assert(sl.contains(x) == (net[x] == 1));
+        expected += net[x];
+    }
+    assert(sl.size() == expected);
+    vector<int> seen;
+    sl.for_each([&](int x) { seen.push_back(x); });
+    assert(seen.size() == expected && is_sorted(seen.begin(), seen.end()));
+    for (size_t i = 0; i < seen.size(); ++i) {
+        assert(*sl.lower_bound(seen[i]) == seen[i]);
+        auto next = sl.upper_bound(seen[i]);
+        assert(i + 1 < seen.size() ? *next == seen[i + 1] : !next);
+    }
+}
+
+int32_t main() {
+    const int max_threads = max(1u, thread::hardware_concurrency());
+    contended_operations(max(4, max_threads), 64, 1 << 16);
+    contended_operations(max(4, max_threads), 1 << 12, 1 << 16);
+
+    mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+    for (int i = 0; i < ops; ++i) {
+        op_key[i] = rng() % keys;
+        int r = rng() % 10;
+        op_type[i] = r < 8 ? 0 : r == 8 ? 1 : 2;  // lookup, insert, erase
+    }
+
+    printf("With %d keys and %d operations:\n", keys, ops);
+    // powers of two, then all cores even when their count is not one
+    vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+    for (int threads : thread_counts) {
+        set<int> locked, shared;
+        cpdsa::concurrent_skip_list<int> sl;
+        for (int x = 0; x < keys; x += 2) {
+            locked.insert(x);
+            shared.insert(x);
+            sl.insert(x);
+        }
+        mutex global_mutex;
+        shared_mutex rw_mutex;
+        atomic<long long> hits_locked{0}, hits_shared{0}, hits_sl{0};
+
+        auto locked_time = timed_ops(threads, [&](int type, int x) {
+            lock_guard<mutex> lock(global_mutex);
+            if (type == 0)
+                hits_locked += locked.count(x);
+            else if (type == 1)
+                locked.insert(x);
+            else
+                locked.erase(x);
+        });
+        auto shared_time = timed_ops(threads, [&](int type, int x) {
+            if (type == 0) {
+                shared_lock lock(rw_mutex);
+                hits_shared += shared.count(x);
+            } else {
+                unique_lock lock(rw_mutex);
+                if (type == 1)
+                    shared.insert(x);
+                else
+                    shared.erase(x);
+            }
+        });
+        auto sl_time = timed_ops(threads, [&](int type, int x) {
+            if (type == 0)
+                hits_sl += sl.contains(x);
+            else if (type == 1)
+                sl.insert(x);
+            else
+                sl.erase(x);
+        });
+
+        if (threads == 1) {
+            assert(hits_sl == hits_locked && hits_sl == hits_shared);
+            assert(sl.size() == locked.size());
+            vector<int> contents;
+            sl.for_each([&](int x) { contents.push_back(x); });
+            assert(equal(contents.begin(), contents.end(), locked.begin(),
+                         locked.end()));
+        }
+
+        printf("%2d thread(s): global mutex %.5f ms, shared_mutex %.5f ms, "
+               "lock-free %.5f ms (%.5fx faster, %.2f Mops/s)\n",
+               threads, locked_time, shared_time, sl_time,
+               min(locked_time, shared_time) / sl_time, ops / sl_time / 1e3);
+    }
+}
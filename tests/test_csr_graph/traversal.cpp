@@ -0,0 +1,158 @@
+/**
+ * CPDSA: CSR graph traversal test -*- C++ -*-
+ *
+ * @file tests/test_csr_graph/traversal.cpp
+ *
+ * Checks BFS, DFS and Dijkstra on random graphs against the same algorithms
+ * over vector<vector<int>>, and reading edges through buffer_scan. Then times
+ * building and running BFS on 2^20 vertices and 2^23 edges with both.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+using adjacency = vector<vector<pair<int, long long>>>;
+constexpr auto UNREACHED = cpdsa::csr_graph<>::UNREACHED;
+
+vector<uint32_t> reference_bfs(const adjacency& adj, int s) {
+    vector<uint32_t> dist(adj.size(), UNREACHED);
+    queue<int> q;
+    dist[s] = 0;
+    q.push(s);
+    while (!q.empty()) {
+        int v = q.front();
+        q.pop();
+        for (auto [u, w] : adj[v])
+            if (dist[u] == UNREACHED)
+                dist[u] = dist[v] + 1, q.push(u);
+    }
+    return dist;
+}
+
+void reference_dfs(const adjacency& adj, int v, vector<bool>& seen,
+                   vector<uint32_t>& order) {
+    seen[v] = true;
+    order.push_back(v);
+    for (auto [u, w] : adj[v])
+        if (!seen[u])
+            reference_dfs(adj, u, seen, order);
+}
+
+vector<long long> reference_dijkstra(const adjacency& adj, int s) {
+    vector<long long> dist(adj.size(), LLONG_MAX);
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<>>
+        pq;
+    pq.push({dist[s] = 0, s});
+    while (!pq.empty()) {
+        auto [d, v] = pq.top();
+        pq.pop();
+        if (d != dist[v])
+            continue;
+        for (auto [u, w] : adj[v])
+            if (d + w < dist[u])
+                pq.push({dist[u] = d + w, u});
+    }
+    return dist;
+}
+
+void random_graphs(int n, int m, bool undirected) {
+    vector<cpdsa::csr_graph<>::edge> edges;
+    vector<cpdsa::csr_graph<long long>::edge> weighted;
+    adjacency adj(n);
+    for (int i = 0; i < m; ++i) {
+        uint32_t u = rand(0, n - 1), v = rand(0, n - 1);
+        long long w = rand(0, 1000);
+        edges.push_back({u, v});
+        weighted.push_back({u, v, w});
+        adj[u].push_back({v, w});
+        if (undirected)
+            adj[v].push_back({u, w});
+    }
+    cpdsa::csr_graph<> g(n, edges, undirected);
+    cpdsa::csr_graph<long long> wg(n, weighted, undirected);
+    assert(g.vertex_count() == (size_t)n && wg.vertex_count() == (size_t)n);
+    assert(g.edge_count() == (size_t)m * (undirected ? 2 : 1));
+    for (int v = 0; v < n; ++v) {
+        assert(g.degree(v) == adj[v].size());
+        auto targets = wg.neighbors(v);
+        auto weights = wg.weights(v);
+        for (size_t i = 0; i < adj[v].size(); ++i)
+            assert(targets[i] == (uint32_t)adj[v][i].first &&
+                   weights[i] == adj[v][i].second);
+    }
+    for (int it = 0; it < 5; ++it) {
+        int s = rand(0, n - 1);
+        assert(g.bfs(s) == reference_bfs(adj, s));
+        vector<bool> seen(n);
+        vector<uint32_t> order;
+        reference_dfs(adj, s, seen, order);
+        assert(g.dfs(s) == order);
+        assert(wg.dijkstra(s) == reference_dijkstra(adj, s));
+    }
+}
+
+void scanning() {
+    const char* path = "test_csr_graph.in";
+    FILE* f = fopen(path, "w");
+    fprintf(f, "1 2 5\n2 3 1\n1 3 9\n3 4 2\n");
+    fclose(f);
+    assert(freopen(path, "r", stdin));
+    auto g = cpdsa::csr_graph<int>::scan(5, 4, true);
+    assert(g.edge_count() == 8);
+    assert(g.dijkstra(0) == vector<int>({0, 5, 6, 8, INT_MAX}));
+    assert(g.bfs(4)[0] == UNREACHED && g.bfs(0)[3] == 2);
+    remove(path);
+}
+
+int32_t main() {
+    random_graphs(1, 0, false);
+    random_graphs(10, 30, false);
+    random_graphs(1000, 3000, false);
+    random_graphs(1000, 3000, true);
+    random_graphs(10000, 9000, true);  // long paths for the DFS stack
+    random_graphs(1 << 15, 1 << 18, false);
+    scanning();
+
+    constexpr int n = 1 << 20, m = 1 << 23;
+    vector<cpdsa::csr_graph<>::edge> edges(m);
+    for (auto& e : edges)
+        e = {(uint32_t)rand(0, n - 1), (uint32_t)rand(0, n - 1)};
+
+    auto start1 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::csr_graph<> g(n, edges);
+    auto start2 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    auto dist = g.bfs(0);
+    auto start3 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    vector<vector<int>> adj(n);
+    for (auto& e : edges)
+        adj[e.from].push_back(e.to);
+    auto start4 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    vector<uint32_t> ref(n, UNREACHED);
+    queue<int> q;
+    ref[0] = 0;
+    q.push(0);
+    while (!q.empty()) {
+        int v = q.front();
+        q.pop();
+        for (int u : adj[v])
+            if (ref[u] == UNREACHED)
+                ref[u] = ref[v] + 1, q.push(u);
+    }
+    auto start5 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(dist == ref);
+
+    auto csr_build = (start2 - start1) / 1e6, vec_build = (start4 - start3) / 1e6;
+    auto csr_bfs = (start3 - start2) / 1e6, vec_bfs = (start5 - start4) / 1e6;
+    printf("With %d vertices and %d edges:\n", n, m);
+    printf("build: cpdsa::csr_graph %.5f ms, vector<vector<int>> %.5f ms\n",
+           csr_build, vec_build);
+    printf("bfs  : cpdsa::csr_graph %.5f ms, vector<vector<int>> %.5f ms "
+           "(%.5fx slower)\n\n",
+           csr_bfs, vec_bfs, vec_bfs / csr_bfs);
+}
@@ -0,0 +1,97 @@
+/**
+ * CPDSA: Fast set smoke test -*- C++ -*-
+ *
+ * @file tests/test_fast_set/smoke_test.cpp
+ *
+ * Runs random operations against both cpdsa::fast_set and std::set over
+ * universes of one, two and four levels, then times 2^20 lower_bound queries
+ * over U = 2^24 against cpdsa::ordered_set and std::set.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+size_t rand(size_t l, size_t r) {
+    return uniform_int_distribution<size_t>(l, r)(rng);
+}
+
+template <size_t U>
+void random_operations(int n) {
+    cpdsa::fast_set<U> st;
+    set<size_t> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 5);
+        size_t x = rand(0, U - 1);
+        if (t <= 2) {
+            assert(st.insert(x) == ref.insert(x).second);
+        } else if (t == 3) {
+            assert(st.erase(x) == (bool)ref.erase(x));
+        } else if (t == 4) {
+            x = rand(0, U + 1);
+            auto it = ref.lower_bound(x);
+            assert(st.lower_bound(x) == (it == ref.end() ? U : *it));
+            assert(st.contains(x) == ref.count(x));
+        } else {
+            x = rand(0, U + 1);
+            auto it = ref.upper_bound(x);
+            assert(st.upper_bound(x) == (it == ref.begin() ? U : *prev(it)));
+            assert(st.front() == (ref.empty() ? U : *ref.begin()));
+            assert(st.back() == (ref.empty() ? U : *ref.rbegin()));
+        }
+        assert(st.size() == ref.size());
+    }
+    st.clear();
+    assert(st.empty() && st.front() == U);
+}
+
+int32_t main() {
+    random_operations<1>(1 << 10);
+    random_operations<64>(1 << 12);
+    random_operations<1000>(1 << 16);
+    random_operations<(1 << 24) - 3>(1 << 16);
+
+    constexpr size_t U = 1 << 24;
+    constexpr int n = 1 << 20;
+    cpdsa::fast_set<U> fs;
+    cpdsa::ordered_set<int, 0, (int)U> os;
+    set<size_t> ss;
+    for (int i = 0; i < n / 4; ++i) {
+        size_t x = rand(0, U - 1);
+        fs.insert(x), os.insert(x), ss.insert(x);
+    }
+    vector<size_t> queries(n);
+    for (auto& q : queries)
+        q = rand(0, U - 1);
+
+    size_t check_fs = 0, check_os = 0, check_ss = 0;
+    auto start1 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    for (size_t q : queries)
+        check_fs += fs.lower_bound(q);
+    auto start2 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    for (size_t q : queries)
+        check_os += os.lower_bound(q);
+    auto start3 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    for (size_t q : queries) {
+        auto it = ss.lower_bound(q);
+        check_ss += it == ss.end() ? U : *it;
+    }
+    auto start4 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    assert(check_fs == check_os && check_fs == check_ss);
+
+    auto fs_time = (start2 - start1) / 1e6;
+    auto os_time = (start3 - start2) / 1e6;
+    auto ss_time = (start4 - start3) / 1e6;
+    printf("With U = %zu, %zu elements and %d queries:\n", U, ss.size(), n);
+    printf("cpdsa::fast_set   : %.5f ms\n", fs_time);
+    printf("cpdsa::ordered_set: %.5f ms (%.5fx slower)\n", os_time,
+           os_time / fs_time);
+    printf("std::set          : %.5f ms (%.5fx slower)\n\n", ss_time,
+           ss_time / fs_time);
+}
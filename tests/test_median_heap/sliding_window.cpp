@@ -0,0 +1,219 @@
+/**
+ * CPDSA: Median heap sliding window test -*- C++ -*-
+ *
+ * @file tests/test_median_heap/sliding_window.cpp
+ *
+ * Checks cpdsa::median_heap against std::multiset on random pushes, pops and
+ * erases, then times the medians of every window of 10^5 elements over a
+ * stream of 2^22 elements, with binary and 4-ary heaps, and bulk construction
+ * against pushing one by one. Also checks deviation_cost() against a full
+ * recount.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+template <size_t Arity>
+void random_operations(int n, int hi) {
+    cpdsa::median_heap<int, Arity> mh;
+    mh.reserve(n);
+    multiset<int> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 4);
+        if (t <= 2 || ref.empty()) {
+            int x = rand(0, hi);
+            mh.push(x);
+            ref.insert(x);
+        } else if (t == 3) {
+            auto it = next(ref.begin(), rand(0, ref.size() - 1));
+            mh.erase(*it);
+            ref.erase(it);
+        } else {
+            mh.pop();
+            ref.erase(next(ref.begin(), (ref.size() - 1) / 2));
+        }
+        assert(mh.size() == ref.size());
+        if (ref.empty())
+            continue;
+        auto mid = next(ref.begin(), (ref.size() - 1) / 2);
+        assert(mh.discrete_median() == *mid);
+        double median = ref.size() % 2 ? *mid : (*mid + *next(mid)) / 2.0;
+        assert(mh.median() == median);
+    }
+    mh.clear();
+    assert(mh.empty());
+}
+
+void bulk_construction(int n, int hi) {
+    vector<int> v(n);
+    for (auto& x : v)
+        x = rand(0, hi);
+    cpdsa::median_heap<int> mh(v.begin(), v.end());
+    multiset<int> ref(v.begin(), v.end());
+    while (!ref.empty()) {
+        assert(mh.size() == ref.size());
+        auto mid = next(ref.begin(), (ref.size() - 1) / 2);
+        assert(mh.discrete_median() == *mid);
+        if (rand(0, 1)) {
+            mh.pop();
+            ref.erase(mid);
+        } else {
+            int x = *next(ref.begin(), rand(0, ref.size() - 1));
+            mh.erase(x);
+            ref.erase(ref.find(x));
+        }
+    }
+    assert(mh.empty());
+}
+
+void deviation_operations(int n, int hi) {
+    cpdsa::median_heap<int, 4, true> mh;
+    multiset<int> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 4);
+        if (t <= 2 || ref.empty()) {
+            int x = rand(-hi, hi);
+            mh.push(x);
+            ref.insert(x);
+        } else if (t == 3) {
+            auto it = next(ref.begin(), rand(0, ref.size() - 1));
+            mh.erase(*it);
+            ref.erase(it);
+        } else {
+            mh.pop();
+            ref.erase(next(ref.begin(), (ref.size() - 1) / 2));
+        }
+        long long sum = 0, cost = 0;
+        if (!ref.empty()) {
+            long long m = *next(ref.begin(), (ref.size() - 1) / 2);
+            for (int x : ref) {
+                sum += x;
+                cost += llabs(x - m);
+            }
+        }
+        assert(mh.sum() == sum);
+        assert(mh.deviation_cost() == cost);
+    }
+    vector<int> v(ref.begin(), ref.end());
+    shuffle(v.begin(), v.end(), rng);
+    cpdsa::median_heap<int, 4, true> built(v.begin(), v.end());
+    assert(built.deviation_cost() == mh.deviation_cost());
+    mh.clear();
+    assert(mh.sum() == 0 && mh.deviation_cost() == 0);
+}
+
+template <size_t Arity>
+long long sliding_medians(const vector<int>& stream, int window) {
+    cpdsa::median_heap<int, Arity> mh;
+    mh.reserve(window + 1);
+    long long check = 0;
+    for (size_t i = 0; i < stream.size(); ++i) {
+        mh.push(stream[i]);
+        if (i >= size_t(window))
+            mh.erase(stream[i - window]);
+        check += mh.discrete_median();
+    }
+    return check;
+}
+
+int32_t main() {
+    random_operations<4>(1 << 14, 1 << 30);
+    random_operations<4>(1 << 14, 16);
+    random_operations<2>(1 << 14, 1 << 30);
+    random_operations<8>(1 << 14, 16);
+    bulk_construction(1, 16);
+    bulk_construction(1 << 12, 1 << 30);
+    bulk_construction(1 << 12, 16);
+    deviation_operations(1 << 12, 1 << 30);
+    deviation_operations(1 << 12, 16);
+
+    constexpr int n = 1 << 22, window = 100000;
+    vector<int> stream(n);
+    for (auto& x : stream)
+        x = rand(0, 1 << 30);
+
+    auto start1 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::median_heap<int> mh;
+    long long check_mh = 0;
+    for (int i = 0; i < n; ++i) {
+        mh.push(stream[i]);
+        if (i >= window)
+            mh.erase(stream[i - window]);
+        check_mh += mh.discrete_median();
+    }
+    auto start2 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    // the usual multiset with an iterator to the median
+    multiset<int> ms;
+    long long check_ms = 0;
+    auto mid = ms.end();
+    for (int i = 0; i < n; ++i) {
+        ms.insert(stream[i]);
+        if (ms.size() == 1)
+            mid = ms.begin();
+        else if (stream[i] < *mid && ms.size() % 2 == 0)
+            --mid;
+        else if (stream[i] >= *mid && ms.size() % 2 == 1)
+            ++mid;
+        if (i >= window) {
+            int x = stream[i - window];
+            auto victim = x == *mid ? mid : ms.find(x);
+            bool odd = ms.size() % 2;
+            if (victim == mid)
+                mid = odd ? prev(mid) : next(mid);
+            else if (x < *mid && !odd)
+                ++mid;
+            else if (x > *mid && odd)
+                --mid;
+            ms.erase(victim);
+        }
+        check_ms += *mid;
+    }
+    auto start3 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    assert(check_mh == check_ms);
+
+    auto mh_time = (start2 - start1) / 1e6;
+    auto ms_time = (start3 - start2) / 1e6;
+    printf("With n = %d and a window of %d:\n", n, window);
+    printf("cpdsa::median_heap: %.5f ms\n", mh_time);
+    printf("std::multiset     : %.5f ms (%.5fx slower)\n\n", ms_time,
+           ms_time / mh_time);
+
+    auto start4 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(sliding_medians<2>(stream, window) == check_ms);
+    auto start5 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(sliding_medians<8>(stream, window) == check_ms);
+    auto start6 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    printf("binary heaps      : %.5f ms\n", (start5 - start4) / 1e6);
+    printf("8-ary heaps       : %.5f ms\n\n", (start6 - start5) / 1e6);
+
+    auto start7 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::median_heap<int> pushed;
+    for (int x : stream)
+        pushed.push(x);
+    auto start8 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::median_heap<int> built(stream.begin(), stream.end());
+    auto start9 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(pushed.discrete_median() == built.discrete_median());
+    auto push_time = (start8 - start7) / 1e6;
+    auto build_time = (start9 - start8) / 1e6;
+    printf("Building from %d elements:\n", n);
+    printf("range constructor : %.5f ms\n", build_time);
+    printf("one push at a time: %.5f ms (%.5fx slower)\n\n", push_time,
+           push_time / build_time);
+}
@@ -0,0 +1,355 @@
+/**
+ * CPDSA: Ordered set smoke test -*- C++ -*-
+ *
+ * @file tests/test_ordered_set/smoke_test.cpp
+ *
+ * Runs random operations against both cpdsa::ordered_set (with the tree and
+ * the flat backend) and std::multiset, checks every version of a
+ * cpdsa::persistent_ordered_set, a cpdsa::bucketed_ordered_set and a
+ * cpdsa::ordered_set_2d, checks that erasing everything frees every node,
+ * round-trips snapshots through save, load and cpdsa::ordered_set_view, then
+ * times 2^20 rank queries issued one by one and as a single batch.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+constexpr int LO = (int)-1e9, HI = (int)1e9;
+
+template <typename Set>
+void random_operations(int n, int lo, int hi) {
+    Set st;
+    multiset<int> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 7), x = rand(lo, hi);
+        if (t <= 2) {
+            st.insert(x);
+            ref.insert(x);
+        } else if (t == 3) {
+            // mostly erase existing values, sometimes absent ones
+            auto it = ref.lower_bound(x);
+            if (it != ref.end() && rand(0, 3))
+                x = *it;
+            st.erase_once(x);
+            it = ref.find(x);
+            if (it != ref.end())
+                ref.erase(it);
+        } else if (t == 4) {
+            auto it = ref.lower_bound(x);
+            assert(st.lower_bound(x) == (it == ref.end() ? st.end() : *it));
+        } else if (t == 5) {
+            int y = rand(x, hi);
+            assert(st.count(x, y) ==
+                   distance(ref.lower_bound(x), ref.upper_bound(y)));
+            assert(st.sum(x, y) == accumulate(ref.lower_bound(x),
+                                              ref.upper_bound(y), 0LL));
+        } else if (t == 6) {
+            size_t rank = distance(ref.begin(), ref.upper_bound(x));
+            assert((size_t)st.order_of_key(x) == rank);
+            assert(st.upper_bound(x) ==
+                   (rank ? *prev(ref.upper_bound(x)) : st.end()));
+        } else {
+            size_t k = rand(1, ref.size() + 1);
+            assert(st.find_by_order(k) ==
+                   (k <= ref.size() ? *next(ref.begin(), k - 1) : st.end()));
+            size_t m = min(k, ref.size());
+            assert(st.sum_of_smallest(k) ==
+                   accumulate(ref.begin(), next(ref.begin(), m), 0LL));
+            assert(st.sum_of_largest(k) ==
+                   accumulate(ref.rbegin(), next(ref.rbegin(), m), 0LL));
+        }
+        assert(st.size() == ref.size());
+    }
+
+    vector<int> queries(n), lefts(n), rights(n);
+    for (int i = 0; i < n; ++i) {
+        queries[i] = rand(lo, hi);
+        lefts[i] = rand(lo, hi), rights[i] = rand(lefts[i], hi);
+    }
+    vector<size_t> ranks(n), counts(n);
+    vector<int> bounds(n);
+    st.order_of_key(queries.begin(), queries.end(), ranks.begin());
+    st.lower_bound(queries.begin(), queries.end(), bounds.begin());
+    st.count(lefts.begin(), lefts.end(), rights.begin(), counts.begin());
+    for (int i = 0; i < n; ++i) {
+        assert((int)ranks[i] == st.order_of_key(queries[i]));
+        assert(bounds[i] == st.lower_bound(queries[i]));
+        assert((int)counts[i] == st.count(lefts[i], rights[i]));
+    }
+
+    // merge in a second set, then split at a random value
+    Set other;
+    for (int i = 0; i < n / 4; ++i) {
+        int x = rand(lo, hi);
+        other.insert(x);
+        ref.insert(x);
+    }
+    st.merge(std::move(other));
+    assert(other.empty() && st.size() == ref.size());
+    assert(st.sum(lo, hi) == accumulate(ref.begin(), ref.end(), 0LL));
+
+    int cut = rand(lo, hi);
+    Set upper = st.split(cut);
+    multiset<int> ref_upper(ref.upper_bound(cut), ref.end());
+    ref.erase(ref.upper_bound(cut), ref.end());
+    assert(st.size() == ref.size() && upper.size() == ref_upper.size());
+    assert(st.sum(lo, hi) == accumulate(ref.begin(), ref.end(), 0LL));
+    assert(upper.sum(lo, hi) ==
+           accumulate(ref_upper.begin(), ref_upper.end(), 0LL));
+    for (int i = 0; i < 64; ++i) {
+        int x = rand(lo, hi);
+        assert((size_t)st.order_of_key(x) ==
+               (size_t)distance(ref.begin(), ref.upper_bound(x)));
+        assert((size_t)upper.order_of_key(x) ==
+               (size_t)distance(ref_upper.begin(), ref_upper.upper_bound(x)));
+    }
+}
+
+void persistent_operations(int n) {
+    cpdsa::persistent_ordered_set<int> st;
+    vector<int> inserted;
+    for (int i = 0; i < n; ++i) {
+        inserted.push_back(rand(LO, HI));
+        st.insert(inserted.back());
+    }
+    st.erase_once(st.latest(), inserted[0]);
+    assert((int)st.size(st.latest()) == n - 1);
+
+    // k-th smallest among insertions lo+1..hi
+    for (int q = 0; q < 256; ++q) {
+        int lo = rand(0, n - 1), hi = rand(lo + 1, n);
+        vector<int> part(inserted.begin() + lo, inserted.begin() + hi);
+        vector<int> prefix(inserted.begin(), inserted.begin() + hi);
+        sort(part.begin(), part.end());
+        sort(prefix.begin(), prefix.end());
+        size_t k = rand(1, hi - lo);
+        assert(st.find_by_order(hi, lo, k) == part[k - 1]);
+        assert(st.find_by_order(hi, k) == prefix[k - 1]);
+
+        int x = rand(LO, HI);
+        assert(st.count(hi, lo, LO, x) ==
+               upper_bound(part.begin(), part.end(), x) - part.begin());
+        auto it = lower_bound(prefix.begin(), prefix.end(), x);
+        assert(st.lower_bound(hi, x) == (it == prefix.end() ? st.end() : *it));
+        it = upper_bound(prefix.begin(), prefix.end(), x);
+        assert(st.upper_bound(hi, x) ==
+               (it == prefix.begin() ? st.end() : *prev(it)));
+    }
+}
+
+void bucketed_operations(int n, int lo, int hi) {
+    cpdsa::bucketed_ordered_set<int> st;
+    cpdsa::ordered_set<int> plain;
+    multiset<int> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 5), x = rand(lo, hi);
+        if (t <= 2) {
+            st.insert(x);
+            plain.insert(x);
+            ref.insert(x);
+        } else if (t == 3) {
+            auto it = ref.lower_bound(x);
+            if (it != ref.end() && rand(0, 3))
+                x = *it;
+            if (rand(0, 1)) {
+                st.erase_once(x);
+                plain.erase_once(x);
+                if ((it = ref.find(x)) != ref.end())
+                    ref.erase(it);
+            } else {
+                st.erase_all(x);
+                plain.erase_all(x);
+                ref.erase(x);
+            }
+        } else if (t == 4) {
+            int y = rand(x, hi);
+            auto it = ref.lower_bound(x);
+            assert(st.lower_bound(x) == (it == ref.end() ? st.end() : *it));
+            assert(st.count(x, y) ==
+                   distance(ref.lower_bound(x), ref.upper_bound(y)));
+            assert(st.sum(x, y) == accumulate(ref.lower_bound(x),
+                                              ref.upper_bound(y), 0LL));
+        } else {
+            size_t rank = distance(ref.begin(), ref.upper_bound(x));
+            assert((size_t)st.order_of_key(x) == rank);
+            assert(st.upper_bound(x) ==
+                   (rank ? *prev(ref.upper_bound(x)) : st.end()));
+            size_t k = rand(1, ref.size() + 1);
+            assert(st.find_by_order(k) ==
+                   (k <= ref.size() ? *next(ref.begin(), k - 1) : st.end()));
+        }
+        assert(st.size() == ref.size());
+    }
+    // sparse values: blocks replace the chains near the leaves
+    if (hi - lo > n)
+        assert(st.node_count() * 4 < plain.node_count());
+
+    for (int x : vector<int>(ref.begin(), ref.end()))
+        st.erase_once(x);
+    assert(st.empty() && st.node_count() == 1);
+}
+
+void planar_operations(int n, int lo, int hi) {
+    cpdsa::ordered_set_2d<int> st;
+    vector<pair<int, int>> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 4), x = rand(lo, hi), y = rand(lo, hi);
+        if (t <= 2) {
+            st.insert(x, y);
+            ref.emplace_back(x, y);
+        } else if (t == 3) {
+            if (!ref.empty() && rand(0, 3)) {
+                swap(ref[rand(0, ref.size() - 1)], ref.back());
+                tie(x, y) = ref.back();
+            }
+            auto it = find(ref.begin(), ref.end(), make_pair(x, y));
+            assert(st.erase_once(x, y) == (it != ref.end()));
+            if (it != ref.end())
+                ref.erase(it);
+        } else {
+            int x2 = rand(x, hi), y2 = rand(y, hi);
+            assert(st.count(x, x2, y, y2) ==
+                   count_if(ref.begin(), ref.end(), [&](auto& p) {
+                       return x <= p.first && p.first <= x2 && y <= p.second &&
+                              p.second <= y2;
+                   }));
+        }
+        assert(st.size() == ref.size());
+    }
+    for (auto [x, y] : ref)
+        assert(st.erase_once(x, y));
+    assert(st.empty() && st.memory_usage() == decltype(st)().memory_usage());
+}
+
+void snapshot_operations(int n) {
+    const string path =
+        (filesystem::temp_directory_path() / "cpdsa_ordered_set.bin").string();
+    cpdsa::ordered_set<int> st, loaded;
+    cpdsa::ordered_set<int, 0, 1 << 12> flat, flat_loaded;
+    for (int i = 0; i < n; ++i) {
+        st.insert(rand(LO, HI));
+        flat.insert(rand(0, (1 << 12) - 1));
+    }
+
+    assert(st.save(path.c_str()) && loaded.load(path.c_str()));
+    assert(!flat_loaded.load(path.c_str()));  // another type
+    cpdsa::ordered_set_view<int> view(path.c_str());
+    assert(view.is_mapped());
+    assert(loaded.size() == st.size() && view.size() == st.size());
+    assert(loaded.node_count() == st.node_count());
+    for (int i = 0; i < 256; ++i) {
+        int x = rand(LO, HI), y = rand(x, HI);
+        size_t k = rand(1, n + 1);
+        assert(loaded.count(x, y) == st.count(x, y));
+        assert(loaded.sum(x, y) == st.sum(x, y));
+        assert(view.count(x, y) == st.count(x, y));
+        assert(view.order_of_key(x) == st.order_of_key(x));
+        assert(view.find_by_order(k) == st.find_by_order(k));
+        assert(view.lower_bound(x) == st.lower_bound(x));
+        assert(view.upper_bound(x) == st.upper_bound(x));
+    }
+
+    // corrupt records with a valid header: a child out of range, a cycle,
+    // a wrong count; none may be loaded, and the view opens them (it checks
+    // the header only) but fails verify() and stays within the file
+    using record = cpdsa::ordered_set_snapshot_node<int>;
+    const size_t records = st.node_count();
+    auto corrupt = [&](size_t at, size_t offset, uint32_t value) {
+        assert(st.save(path.c_str()));
+        FILE* f = fopen(path.c_str(), "r+b");
+        fseek(f, sizeof(cpdsa::ordered_set_snapshot_header) +
+                     at * sizeof(record) + offset, SEEK_SET);
+        fwrite(&value, sizeof(value), 1, f);
+        fclose(f);
+        cpdsa::ordered_set<int> bad;
+        assert(!bad.load(path.c_str()) && bad.empty());
+        assert(view.open(path.c_str()) && !view.verify());
+        long long answers = 0;
+        for (int i = 0; i < 256; ++i) {
+            int x = rand(LO, HI), y = rand(x, HI);
+            answers += view.count(x, y) + view.find_by_order(rand(1, n)) +
+                       view.lower_bound(x) + view.upper_bound(y);
+        }
+        (void)answers;
+    };
+    corrupt(0, offsetof(record, left_child), records);
+    corrupt(0, offsetof(record, right_child), uint32_t(-1));
+    corrupt(records - 1, offsetof(record, left_child), 1);
+    corrupt(1, offsetof(record, cnt), st.size() + 1);
+    corrupt(0, offsetof(record, lowest_value), HI + 1);
+    assert(st.save(path.c_str()) && view.open(path.c_str()) && view.verify());
+
+    assert(flat.save(path.c_str()) && flat_loaded.load(path.c_str()));
+    assert(!loaded.load(path.c_str()) && !view.open(path.c_str()));
+    assert(view.empty() && loaded.size() == st.size());
+    assert(flat_loaded.size() == flat.size());
+    for (int i = 0; i < 256; ++i) {
+        int x = rand(0, 1 << 12), y = rand(x, 1 << 12);
+        assert(flat_loaded.sum(x, y) == flat.sum(x, y));
+        assert(flat_loaded.find_by_order(x) == flat.find_by_order(x));
+    }
+    filesystem::remove(path);
+}
+
+void churn(int n) {
+    cpdsa::ordered_set<unsigned> st;
+    const size_t empty_usage = st.memory_usage();
+    vector<unsigned> values(n);
+    for (int round = 0; round < 4; ++round) {
+        for (auto& x : values)
+            st.insert(x = rng());
+        assert(st.node_count() > (size_t)n);
+        for (auto x : values)
+            st.erase_once(x);
+        // every emptied subtree must have been freed
+        assert(st.empty() && st.node_count() == 1);
+        assert(st.memory_usage() == empty_usage);
+    }
+}
+
+int32_t main() {
+    random_operations<cpdsa::ordered_set<int>>(1 << 14, LO, HI);
+    random_operations<cpdsa::ordered_set<int, 0, 1 << 12>>(1 << 14, 0,
+                                                           (1 << 12) - 1);
+    persistent_operations(1 << 12);
+    bucketed_operations(1 << 15, LO, HI);
+    bucketed_operations(1 << 15, 0, 1 << 6);
+    planar_operations(1 << 12, LO, HI);
+    planar_operations(1 << 12, 0, 1 << 5);
+    snapshot_operations(1 << 14);
+    churn(1 << 14);
+
+    constexpr int n = 1 << 20;
+    cpdsa::ordered_set<int> st;
+    for (int i = 0; i < n; ++i)
+        st.insert(rand(LO, HI));
+    vector<int> queries(n);
+    for (auto& q : queries)
+        q = rand(LO, HI);
+    vector<size_t> single(n), batched(n);
+
+    auto start1 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    for (int i = 0; i < n; ++i)
+        single[i] = st.order_of_key(queries[i]);
+    auto start2 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    st.order_of_key(queries.begin(), queries.end(), batched.begin());
+    auto start3 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    assert(single == batched);
+
+    auto single_time = (start2 - start1) / 1e6;
+    auto batch_time = (start3 - start2) / 1e6;
+    printf("With n = %d:\n", n);
+    printf("order_of_key, one by one : %.5f ms\n", single_time);
+    printf("order_of_key, batched    : %.5f ms (%.5fx faster)\n\n", batch_time,
+           single_time / batch_time);
+}
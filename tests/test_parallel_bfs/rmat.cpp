@@ -0,0 +1,113 @@
+/**
+ * CPDSA: Parallel BFS test and benchmark -*- C++ -*-
+ *
+ * @file tests/test_parallel_bfs/rmat.cpp
+ *
+ * Checks parallel_bfs against csr_graph::bfs on random directed and
+ * undirected graphs, from 1 to 8 threads. Then, on an undirected R-MAT graph
+ * (a = 0.57, b = c = 0.19, d = 0.05) with 2^20 vertices and 2^24 edges, times
+ * csr_graph::bfs and parallel_bfs from 1, 2, 4, ... threads, up to all cores.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+using graph = cpdsa::csr_graph<>;
+
+void random_graphs(int n, int m, bool undirected) {
+    vector<graph::edge> edges;
+    for (int i = 0; i < m; ++i)
+        edges.push_back({(uint32_t)rand(0, n - 1), (uint32_t)rand(0, n - 1)});
+    graph g(n, edges, undirected), t = g.transpose();
+    assert(t.edge_count() == g.edge_count());
+    for (int it = 0; it < 3; ++it) {
+        uint32_t s = rand(0, n - 1);
+        auto expected = g.bfs(s);
+        for (unsigned threads : {1, 2, 3, 8}) {
+            auto dist = cpdsa::parallel_bfs(g, s, t, threads);
+            assert(dist == expected);
+            dist = cpdsa::parallel_bfs(g, s, threads);  // builds t itself
+            assert(dist == expected);
+            if (undirected) {
+                dist = cpdsa::parallel_bfs_undirected(g, s, threads);
+                assert(dist == expected);
+            }
+        }
+    }
+}
+
+void transposes() {
+    cpdsa::csr_graph<int> g(4, {{0, 1, 5}, {0, 2, 7}, {2, 1, 3}, {3, 0, 1}});
+    auto t = g.transpose();
+    assert(t.edge_count() == 4 && t.degree(0) == 1 && t.degree(1) == 2);
+    assert(t.neighbors(1)[0] == 0 && t.weights(1)[0] == 5);
+    assert(t.neighbors(1)[1] == 2 && t.weights(1)[1] == 3);
+    assert(t.neighbors(0)[0] == 3 && t.weights(0)[0] == 1);
+    assert(t.transpose().dijkstra(0) == g.dijkstra(0));
+}
+
+// R-MAT: each edge picks a quadrant of the adjacency matrix scale times
+vector<graph::edge> rmat(int scale, int m) {
+    vector<graph::edge> edges(m);
+    vector<uint32_t> label(1 << scale);
+    iota(label.begin(), label.end(), 0);
+    shuffle(label.begin(), label.end(), rng);  // hubs not all near vertex 0
+    for (auto& e : edges) {
+        uint32_t u = 0, v = 0;
+        for (int bit = 0; bit < scale; ++bit) {
+            int r = rand(0, 99);
+            bool down = r >= 57 + 19, right = (r >= 57 && r < 57 + 19) || r >= 95;
+            u = u << 1 | down;
+            v = v << 1 | right;
+        }
+        e = {label[u], label[v]};
+    }
+    return edges;
+}
+
+int32_t main() {
+    random_graphs(1, 0, false);
+    random_graphs(100, 50, true);  // mostly isolated vertices
+    random_graphs(1000, 3000, false);
+    random_graphs(1000, 20000, true);
+    random_graphs(1 << 15, 1 << 19, false);
+    random_graphs(1 << 15, 1 << 19, true);
+    random_graphs(100000, 100000, true);  // long, thin levels
+    transposes();
+
+    constexpr int scale = 20, n = 1 << scale, m = 16 << scale;
+    graph g(n, rmat(scale, m), true);
+    uint32_t s = 0;
+    while (g.degree(s) == 0)
+        ++s;
+
+    auto start1 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    auto expected = g.bfs(s);
+    auto start2 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    auto serial = (start2 - start1) / 1e6;
+
+    printf("With an R-MAT graph of %d vertices and %d edges:\n", n, m);
+    printf("csr_graph::bfs: %.5f ms\n", serial);
+    const int max_threads = max(1u, thread::hardware_concurrency());
+    // powers of two, then all cores even when their count is not one
+    vector<int> thread_counts;
+    for (int threads = 1; threads < max_threads; threads *= 2)
+        thread_counts.push_back(threads);
+    thread_counts.push_back(max_threads);
+    for (int threads : thread_counts) {
+        auto start3 = chrono::high_resolution_clock::now().time_since_epoch().count();
+        auto dist = cpdsa::parallel_bfs_undirected(g, s, threads);
+        auto start4 = chrono::high_resolution_clock::now().time_since_epoch().count();
+        assert(dist == expected);
+        auto parallel = (start4 - start3) / 1e6;
+        printf("%2d thread(s): parallel_bfs %.5f ms (%.5fx faster)\n", threads,
+               parallel, serial / parallel);
+    }
+    printf("\n");
+}
@@ -0,0 +1,111 @@
+/**
+ * CPDSA: Quantile heap smoke test -*- C++ -*-
+ *
+ * @file tests/test_quantile_heap/smoke_test.cpp
+ *
+ * Checks cpdsa::quantile_heap and cpdsa::quantile_pool against a sorted
+ * std::multiset, then times 2^22 pushes into a p99 quantile_heap, into three
+ * quantile_heaps for p50, p90 and p99, and into a pool of the same three.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+int nth(const multiset<int>& ref, double q) {
+    size_t k = max<size_t>(1, (size_t)ceil(q * ref.size() - 1e-9));
+    return *next(ref.begin(), k - 1);
+}
+
+template <typename Heap>
+void random_operations(Heap qh, int n, int hi) {
+    multiset<int> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 4);
+        if (t <= 2 || ref.empty()) {
+            int x = rand(0, hi);
+            qh.push(x);
+            ref.insert(x);
+        } else if (t == 3) {
+            auto it = next(ref.begin(), rand(0, ref.size() - 1));
+            qh.erase(*it);
+            ref.erase(it);
+        } else {
+            ref.erase(ref.find(nth(ref, qh.ratio())));
+            qh.pop();
+        }
+        assert(qh.size() == ref.size());
+        if (!ref.empty())
+            assert(qh.quantile() == nth(ref, qh.ratio()));
+    }
+}
+
+void pool_operations(int n, int hi) {
+    vector<double> qs = {0.99, 0.5, 0.9, 0.5, 0.0, 1.0, 0.25, 0.3, 0.7};
+    cpdsa::quantile_pool<int> pool(qs.begin(), qs.end());
+    multiset<int> ref;
+    for (int i = 0; i < n; ++i) {
+        int x = rand(0, hi);
+        pool.push(x);
+        ref.insert(x);
+        assert(pool.size() == ref.size());
+        for (size_t j = 0; j < qs.size(); ++j)
+            assert(pool.quantile(j) == nth(ref, qs[j]));
+    }
+}
+
+int32_t main() {
+    for (int hi : {1 << 30, 8}) {
+        random_operations(cpdsa::quantile_heap<int>(), 1 << 12, hi);
+        random_operations(cpdsa::quantile_heap<int, ratio<9, 10>>(), 1 << 12,
+                          hi);
+        for (double q : {0.0, 0.01, 0.5, 0.99, 1.0, -0.5, 1.5})
+            random_operations(cpdsa::quantile_heap<int>(q), 1 << 12, hi);
+        pool_operations(1 << 12, hi);
+    }
+
+    constexpr int n = 1 << 22;
+    vector<int> stream(n);
+    for (auto& x : stream)
+        x = rand(0, 1 << 30);
+
+    auto start1 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::quantile_heap<int, ratio<99, 100>> qh;
+    for (int x : stream)
+        qh.push(x);
+    auto start2 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::quantile_heap<int> p50(0.5), p90(0.9), p99(0.99);
+    for (int x : stream) {
+        p50.push(x);
+        p90.push(x);
+        p99.push(x);
+    }
+    auto start3 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::quantile_pool<int> pool{0.5, 0.9, 0.99};
+    for (int x : stream)
+        pool.push(x);
+    auto start4 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    assert(qh.quantile() == pool.quantile(2));
+    assert(p50.quantile() == pool.quantile(0) &&
+           p90.quantile() == pool.quantile(1) &&
+           p99.quantile() == pool.quantile(2));
+
+    auto heap_time = (start2 - start1) / 1e6;
+    auto heaps_time = (start3 - start2) / 1e6;
+    auto pool_time = (start4 - start3) / 1e6;
+    printf("With n = %d:\n", n);
+    printf("quantile_heap, p99            : %.5f ms\n", heap_time);
+    printf("quantile_heap x3, p50/p90/p99: %.5f ms\n", heaps_time);
+    printf("quantile_pool, p50/p90/p99   : %.5f ms (%.5fx faster)\n\n",
+           pool_time, heaps_time / pool_time);
+}
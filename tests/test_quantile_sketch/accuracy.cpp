@@ -0,0 +1,105 @@
+/**
+ * CPDSA: Quantile sketch accuracy benchmark -*- C++ -*-
+ *
+ * @file tests/test_quantile_sketch/accuracy.cpp
+ *
+ * Checks cpdsa::quantile_sketch against cpdsa::median_heap on short streams,
+ * where it is exact. Then feeds 2^22 elements to both (the sketch whole, and
+ * as 8 merged parts), and compares their memory, time and the rank error of
+ * the sketch's quantiles.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+/**
+ * Returns the largest error, as a fraction of n, between the rank the sketch
+ * gives its answers and their true rank.
+ */
+double max_rank_error(const cpdsa::quantile_sketch<int>& sk,
+                      const vector<int>& sorted) {
+    double worst = 0;
+    for (int i = 0; i <= 100; ++i) {
+        double q = i / 100.0;
+        int x = sk.quantile(q);
+        // x stands for any rank in [lo, hi]
+        double lo = lower_bound(sorted.begin(), sorted.end(), x) -
+                    sorted.begin() + 1;
+        double hi = upper_bound(sorted.begin(), sorted.end(), x) -
+                    sorted.begin();
+        double want = max(1.0, ceil(q * sorted.size()));
+        double err = want < lo ? lo - want : want > hi ? want - hi : 0;
+        worst = max(worst, err / sorted.size());
+
+        double rank = upper_bound(sorted.begin(), sorted.end(), x) -
+                      sorted.begin();
+        worst = max(worst, fabs((double)sk.rank(x) - rank) / sorted.size());
+    }
+    return worst;
+}
+
+void small_streams() {
+    // below k elements the sketch is exact, so it must agree with median_heap
+    cpdsa::quantile_sketch<int> sk;
+    cpdsa::median_heap<int> mh;
+    for (int i = 0; i < 100; ++i) {
+        int x = rand(0, 50);
+        sk.push(x);
+        mh.push(x);
+        assert(sk.median() == mh.median());
+        assert(sk.discrete_median() == mh.discrete_median());
+    }
+}
+
+int32_t main() {
+    small_streams();
+
+    constexpr int n = 1 << 22, parts = 8;
+    vector<int> stream(n);
+    for (int i = 0; i < n; ++i)  // a drifting, skewed stream
+        stream[i] = rand(0, 1 << 20) + (rand(0, 9) ? 0 : i);
+
+    auto start1 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::quantile_sketch<int> sk;
+    for (int x : stream)
+        sk.push(x);
+    auto start2 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::median_heap<int> mh;
+    for (int x : stream)
+        mh.push(x);
+    auto start3 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    vector<cpdsa::quantile_sketch<int>> partial(parts);
+    for (int i = 0; i < n; ++i)
+        partial[i % parts].push(stream[i]);
+    cpdsa::quantile_sketch<int> merged;
+    for (auto& p : partial)
+        merged.merge(p);
+
+    vector<int> sorted(stream);
+    sort(sorted.begin(), sorted.end());
+    assert(sk.size() == (size_t)n && merged.size() == (size_t)n);
+    double err = max_rank_error(sk, sorted);
+    double merged_err = max_rank_error(merged, sorted);
+    assert(err < 0.02 && merged_err < 0.02);
+    assert(sk.retained() < 4 * 200);
+
+    auto sk_time = (start2 - start1) / 1e6;
+    auto mh_time = (start3 - start2) / 1e6;
+    printf("With n = %d:\n", n);
+    printf("cpdsa::median_heap     : %.5f ms, ~%zu bytes, median %d\n",
+           mh_time, n * sizeof(int), mh.discrete_median());
+    printf("cpdsa::quantile_sketch : %.5f ms, %zu bytes, median %d\n", sk_time,
+           sk.memory_usage(), sk.discrete_median());
+    printf("max rank error, whole  : %.5f%%\n", err * 100);
+    printf("max rank error, merged : %.5f%%\n\n", merged_err * 100);
+}
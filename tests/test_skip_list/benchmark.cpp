@@ -0,0 +1,193 @@
+/**
+ * CPDSA: Skip list benchmark -*- C++ -*-
+ *
+ * @file tests/test_skip_list/benchmark.cpp
+ *
+ * Runs random operations against both cpdsa::skip_list and std::set, with
+ * small and large elements, then times 2^20 insertions, 2^22 lookups and
+ * 2^20 erasures against std::set. Finally times order_of_key and
+ * find_by_order over 2^18 strings against __gnu_pbds::tree.
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+using namespace std;
+
+template <typename T>
+using pbds_set = __gnu_pbds::tree<T, __gnu_pbds::null_type, less<T>,
+                                  __gnu_pbds::rb_tree_tag,
+                                  __gnu_pbds::tree_order_statistics_node_update>;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+// bigger than a pointer, so not cached in links
+struct wide {
+    int key = 0;
+    char payload[60] = {};
+    wide() = default;
+    wide(int key_) : key(key_) {}
+    auto operator<=>(const wide& other) const { return key <=> other.key; }
+    bool operator==(const wide& other) const { return key == other.key; }
+};
+
+template <typename T>
+void random_operations(int n, int hi) {
+    cpdsa::skip_list<T> sl;
+    pbds_set<T> ref;
+    for (int i = 0; i < n; ++i) {
+        int t = rand(1, 7);
+        T x = rand(0, hi);
+        if (t <= 2) {
+            assert(sl.insert(x) == ref.insert(x).second);
+        } else if (t == 3) {
+            assert(sl.erase(x) == (bool)ref.erase(x));
+        } else if (t == 4) {
+            auto it = ref.lower_bound(x);
+            auto jt = sl.lower_bound(x);
+            assert((it == ref.end()) == (jt == sl.end()));
+            assert(it == ref.end() || *it == *jt);
+            assert(sl.contains(x) == (ref.find(x) != ref.end()));
+        } else if (t == 5) {
+            auto it = ref.upper_bound(x);
+            auto jt = sl.upper_bound(x);
+            assert((it == ref.end()) == (jt == sl.end()));
+            assert(it == ref.end() || *it == *jt);
+        } else if (t == 6) {
+            assert(sl.order_of_key(x) == ref.order_of_key(x) +
+                                             (ref.find(x) != ref.end()));
+            size_t k = rand(0, ref.size() + 1);
+            auto it = sl.find_by_order(k);
+            if (k == 0 || k > ref.size())
+                assert(it == sl.end());
+            else
+                assert(*it == *ref.find_by_order(k - 1));
+        } else if (!ref.empty()) {
+            assert(*prev(sl.end()) == *prev(ref.end()));
+            assert(*sl.begin() == *ref.begin());
+        }
+        assert(sl.size() == ref.size());
+    }
+    assert(equal(sl.begin(), sl.end(), ref.begin(), ref.end()));
+    for (size_t k = 1; k <= ref.size(); ++k)
+        assert(sl.order_of_key(*sl.find_by_order(k)) == k);
+    vector<T> backwards(ref.rbegin(), ref.rend());
+    auto it = sl.end();
+    for (auto& x : backwards)
+        assert(*--it == x);
+    assert(it == sl.begin());
+
+    cpdsa::skip_list<T> moved(std::move(sl));
+    assert(moved.size() == ref.size() && sl.empty());
+    moved.clear();
+    assert(moved.empty() && moved.begin() == moved.end());
+    moved.insert(T(1));
+    assert(moved.size() == 1 && *moved.begin() == T(1));
+}
+
+int32_t main() {
+    random_operations<int>(1 << 16, 1 << 30);
+    random_operations<int>(1 << 16, 1 << 10);
+    random_operations<int>(1 << 16, 64);
+    random_operations<long long>(1 << 16, 1 << 8);
+    random_operations<wide>(1 << 14, 1 << 8);
+
+    constexpr int n = 1 << 20, q = 1 << 22;
+    vector<int> keys(n), queries(q);
+    for (auto& x : keys)
+        x = rand(0, INT_MAX);
+    for (auto& x : queries)
+        x = rand(0, INT_MAX);
+
+    auto start1 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    cpdsa::skip_list<int> sl;
+    for (int x : keys)
+        sl.insert(x);
+    auto start2 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    long long check_sl = 0;
+    for (int x : queries) {
+        auto it = sl.lower_bound(x);
+        check_sl += it == sl.end() ? -1 : *it;
+    }
+    auto start3 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    for (int x : keys)
+        sl.erase(x);
+    auto start4 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    set<int> st;
+    for (int x : keys)
+        st.insert(x);
+    auto start5 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    long long check_st = 0;
+    for (int x : queries) {
+        auto it = st.lower_bound(x);
+        check_st += it == st.end() ? -1 : *it;
+    }
+    auto start6 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    for (int x : keys)
+        st.erase(x);
+    auto start7 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+
+    assert(check_sl == check_st);
+    assert(sl.empty());
+
+    auto sl_insert = (start2 - start1) / 1e6, st_insert = (start5 - start4) / 1e6;
+    auto sl_query = (start3 - start2) / 1e6, st_query = (start6 - start5) / 1e6;
+    auto sl_erase = (start4 - start3) / 1e6, st_erase = (start7 - start6) / 1e6;
+    printf("With %d elements and %d lookups:\n", n, q);
+    printf("insert     : cpdsa::skip_list %.5f ms, std::set %.5f ms\n",
+           sl_insert, st_insert);
+    printf("lower_bound: cpdsa::skip_list %.5f ms, std::set %.5f ms "
+           "(%.5fx slower)\n",
+           sl_query, st_query, st_query / sl_query);
+    printf("erase      : cpdsa::skip_list %.5f ms, std::set %.5f ms\n\n",
+           sl_erase, st_erase);
+
+    constexpr int m = 1 << 18;
+    vector<string> words(m);
+    for (auto& w : words) {
+        w.resize(rand(4, 12));
+        for (auto& c : w)
+            c = 'a' + rand(0, 25);
+    }
+    cpdsa::skip_list<string> sl_words;
+    pbds_set<string> pb_words;
+    for (auto& w : words) {
+        sl_words.insert(w);
+        pb_words.insert(w);
+    }
+    auto start8 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    size_t check_sl_words = 0;
+    for (int i = 0; i < m; ++i) {
+        check_sl_words += sl_words.order_of_key(words[i]);
+        check_sl_words +=
+            sl_words.find_by_order(i % sl_words.size() + 1)->size();
+    }
+    auto start9 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    size_t check_pb_words = 0;
+    for (int i = 0; i < m; ++i) {
+        check_pb_words += pb_words.order_of_key(words[i]) + 1;
+        check_pb_words += pb_words.find_by_order(i % pb_words.size())->size();
+    }
+    auto start10 =
+        chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(check_sl_words == check_pb_words);
+
+    auto sl_rank = (start9 - start8) / 1e6, pb_rank = (start10 - start9) / 1e6;
+    printf("With %d strings, order_of_key and find_by_order each:\n", m);
+    printf("cpdsa::skip_list: %.5f ms\n", sl_rank);
+    printf("__gnu_pbds::tree: %.5f ms (%.5fx slower)\n\n", pb_rank,
+           pb_rank / sl_rank);
+}
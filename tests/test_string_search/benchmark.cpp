@@ -0,0 +1,154 @@
+/**
+ * CPDSA: String search test and benchmark -*- C++ -*-
+ *
+ * @file tests/test_string_search/benchmark.cpp
+ *
+ * Checks string_search against std::string_view::find on random texts over
+ * small alphabets, and its worst case on texts defeating the filter. Then,
+ * in 2^25 random letters, times finding a pattern at the end of the text
+ * and counting the occurrences of a short one with:
+ *  - std::string::find
+ *  - std::boyer_moore_horspool_searcher
+ *  - cpdsa::string_search
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+string random_string(int n, int letters) {
+    string s(n, 0);
+    for (auto& c : s)
+        c = 'a' + rand(0, letters - 1);
+    return s;
+}
+
+vector<size_t> naive_find_all(string_view text, string_view pattern) {
+    vector<size_t> result;
+    for (size_t at = text.find(pattern); at != string::npos;
+         at = text.find(pattern, at + 1))
+        result.push_back(at);
+    return result;
+}
+
+void random_texts(int n, int m, int letters) {
+    string text = random_string(n, letters);
+    string pattern = rand(0, 1) && n >= m ? text.substr(rand(0, n - m), m)
+                                          : random_string(m, letters);
+    cpdsa::string_search s(pattern);
+    auto expected = naive_find_all(text, pattern);
+    assert(s.size() == pattern.size());
+    assert(s.find_all(text) == expected && s.count(text) == expected.size());
+    for (int it = 0; it < 10; ++it) {
+        [[maybe_unused]] size_t from = rand(0, n + 1);
+        assert(s.find(text, from) == string_view(text).find(pattern, from));
+    }
+}
+
+void worst_cases() {
+    // every position passes the filter and fails in the middle
+    constexpr int n = 1 << 22, m = 1000;
+    string text(n, 'a');
+    string pattern = string(m / 2, 'a') + "b" + string(m / 2, 'a');
+    auto start = chrono::high_resolution_clock::now().time_since_epoch().count();
+    size_t none = cpdsa::string_search(pattern).count(text);
+    text[n / 2] = 'b';
+    auto one = cpdsa::string_search(pattern).find_all(text);
+    size_t all_but = cpdsa::string_search(string(m, 'a')).count(text);
+    auto stop = chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(none == 0 && one == vector<size_t>{n / 2 - m / 2});
+    assert(all_but == n - 2 * m + 1);
+    // printing the counts keeps the searches under NDEBUG
+    printf("Worst cases with %d bytes and a pattern of %d: %.5f ms (%zu, %zu "
+           "matches)\n\n",
+           n, m, (stop - start) / 1e6, none + one.size(), all_but);
+}
+
+void special_cases() {
+    cpdsa::string_search empty("");
+    assert(empty.count("abc") == 4 && empty.find("abc", 2) == 2 &&
+           empty.find("abc", 4) == string::npos);
+    string bytes = string("x\0\xff\0y", 5) + string(100, '\xff');
+    cpdsa::string_search s(string("\0\xff", 2));
+    assert(s.find_all(bytes) == vector<size_t>{1});
+    assert(cpdsa::string_search("\xff\xff").count(bytes) == 99);
+    assert(cpdsa::string_search("long pattern").find("short") == string::npos);
+}
+
+size_t checksum = 0;  // of every timed result, printed so none is dropped
+
+template <typename Search>
+double timed(Search&& search, [[maybe_unused]] size_t expected) {
+    auto start = chrono::high_resolution_clock::now().time_since_epoch().count();
+    size_t result = search();
+    auto stop = chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(result == expected);
+    checksum += result;
+    return (stop - start) / 1e6;
+}
+
+int32_t main() {
+    for (int m : {1, 2, 3, 5, 17, 40, 100})
+        for (int letters : {1, 2, 4, 26}) {
+            random_texts(m / 2, m, letters);
+            random_texts(1000, m, letters);
+            random_texts(20000, m, letters);
+        }
+    special_cases();
+    worst_cases();
+
+    constexpr int n = 1 << 25;
+    string text = random_string(n, 26);
+    printf("With %d random letters:\n", n);
+    for (int m : {8, 16, 64}) {
+        string pattern = text.substr(n - m);
+        size_t expected = text.find(pattern);
+        boyer_moore_horspool_searcher bmh(pattern.begin(), pattern.end());
+        cpdsa::string_search s(pattern);
+        auto std_time = timed([&] { return text.find(pattern); }, expected);
+        auto bmh_time = timed(
+            [&] {
+                return size_t(search(text.begin(), text.end(), bmh) -
+                              text.begin());
+            },
+            expected);
+        auto cpdsa_time = timed([&] { return s.find(text); }, expected);
+        printf("find  (m = %2d): std::string::find %.5f ms, horspool %.5f ms, "
+               "cpdsa::string_search %.5f ms (%.5fx, %.5fx faster)\n",
+               m, std_time, bmh_time, cpdsa_time, std_time / cpdsa_time,
+               bmh_time / cpdsa_time);
+    }
+    string pattern = "abc";
+    size_t expected = naive_find_all(text, pattern).size();
+    boyer_moore_horspool_searcher bmh(pattern.begin(), pattern.end());
+    cpdsa::string_search s(pattern);
+    auto std_time = timed(
+        [&] {
+            size_t result = 0;
+            for (size_t at = text.find(pattern); at != string::npos;
+                 at = text.find(pattern, at + 1))
+                ++result;
+            return result;
+        },
+        expected);
+    auto bmh_time = timed(
+        [&] {
+            size_t result = 0;
+            for (auto it = search(text.begin(), text.end(), bmh);
+                 it != text.end(); it = search(it + 1, text.end(), bmh))
+                ++result;
+            return result;
+        },
+        expected);
+    auto cpdsa_time = timed([&] { return s.count(text); }, expected);
+    printf("count (m =  3): std::string::find %.5f ms, horspool %.5f ms, "
+           "cpdsa::string_search %.5f ms (%.5fx, %.5fx faster)\n",
+           std_time, bmh_time, cpdsa_time, std_time / cpdsa_time,
+           bmh_time / cpdsa_time);
+    printf("checksum: %zu\n\n", checksum);
+}
@@ -0,0 +1,177 @@
+/**
+ * CPDSA: Tree LCA test and benchmark -*- C++ -*-
+ *
+ * @file tests/test_tree/lca.cpp
+ *
+ * Checks tree against walking up parent links on random trees, paths and
+ * stars, built from parents, edges and stdin. Then, on a random tree of
+ * 2^20 vertices, times 2^22 LCA queries with:
+ *  - binary lifting over vector<vector<int>>, with a recursive DFS
+ *  - cpdsa::tree, one query at a time
+ *  - cpdsa::tree, all queries in one batch
+ */
+
+#include <bits/stdc++.h>
+#include <cpdsa/cpdsa.hpp>
+using namespace std;
+using cpdsa::tree;
+
+mt19937 rng(chrono::high_resolution_clock::now().time_since_epoch().count());
+int rand(int l, int r) {
+    return uniform_int_distribution<int>(l, r)(rng);
+}
+
+uint32_t naive_lca(const vector<uint32_t>& parent, uint32_t u, uint32_t v) {
+    vector<bool> ancestor(parent.size());
+    for (; u != tree::NONE; u = parent[u])
+        ancestor[u] = true;
+    for (; !ancestor[v]; v = parent[v])
+        ;
+    return v;
+}
+
+// parent[v] for a random tree on n vertices rooted at root, relabeled
+vector<uint32_t> random_parents(int n, int root, int shape) {
+    vector<int> label(n);
+    iota(label.begin(), label.end(), 0);
+    shuffle(label.begin(), label.end(), rng);
+    swap(*find(label.begin(), label.end(), root), label[0]);
+    vector<uint32_t> parent(n, tree::NONE);
+    for (int i = 1; i < n; ++i) {
+        int p = shape == 0 ? rand(0, i - 1) : shape == 1 ? i - 1 : 0;
+        parent[label[i]] = label[p];
+    }
+    return parent;
+}
+
+void check(const tree& t, const vector<uint32_t>& parent) {
+    int n = parent.size();
+    assert(t.vertex_count() == (size_t)n && t.parent(t.root()) == tree::NONE);
+    auto order = t.preorder();
+    for (int v = 0; v < n; ++v) {
+        assert(t.parent(v) == parent[v] && order[t.index(v)] == (uint32_t)v);
+        if (parent[v] != tree::NONE) {
+            assert(t.depth(v) == t.depth(parent[v]) + 1);
+            assert(t.is_ancestor(parent[v], v) && !t.is_ancestor(v, parent[v]));
+        }
+    }
+    vector<size_t> size(n, 1);
+    for (int i = n - 1; i > 0; --i)
+        size[t.parent(order[i])] += size[order[i]];
+    for (int v = 0; v < n; ++v)
+        assert(t.subtree_size(v) == size[v]);
+
+    vector<pair<uint32_t, uint32_t>> queries(n < 5000 ? 3000 : 100);
+    for (auto& [u, v] : queries)
+        u = rand(0, n - 1), v = rand(0, n - 1);
+    auto answers = t.lca(queries);
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto [u, v] = queries[i];
+        uint32_t w = naive_lca(parent, u, v);
+        assert(t.lca(u, v) == w && answers[i] == w);
+        assert(t.distance(u, v) == t.depth(u) + t.depth(v) - 2 * t.depth(w));
+        assert(t.is_ancestor(w, u) && t.is_ancestor(w, v));
+    }
+}
+
+void random_trees(int n, int shape) {
+    int root = rand(0, n - 1);
+    auto parent = random_parents(n, root, shape);
+    check(tree(parent), parent);
+    vector<tree::edge> edges;
+    for (int v = 0; v < n; ++v)
+        if (parent[v] != tree::NONE) {
+            if (rand(0, 1))
+                edges.push_back({parent[v], (uint32_t)v});
+            else
+                edges.push_back({(uint32_t)v, parent[v]});
+        }
+    shuffle(edges.begin(), edges.end(), rng);
+    check(tree(n, edges, root), parent);
+}
+
+void scanning() {
+    const char* path = "test_tree.in";
+    FILE* f = fopen(path, "w");
+    fprintf(f, "1 2\n3 1\n4 3\n3 5\n");
+    fclose(f);
+    assert(freopen(path, "r", stdin));
+    auto t = tree::scan(5);
+    assert(t.lca(3, 4) == 2 && t.lca(1, 3) == 0 && t.distance(1, 4) == 3);
+    remove(path);
+}
+
+constexpr int LOG = 20;
+vector<vector<int>> adj;
+vector<array<int, LOG + 1>> up;
+vector<int> dep;
+
+void lifting_dfs(int v, int p) {
+    up[v][0] = p;
+    for (int k = 1; k <= LOG; ++k)
+        up[v][k] = up[up[v][k - 1]][k - 1];
+    for (int u : adj[v])
+        if (u != p)
+            dep[u] = dep[v] + 1, lifting_dfs(u, v);
+}
+
+int lifting_lca(int u, int v) {
+    if (dep[u] < dep[v])
+        swap(u, v);
+    for (int k = LOG; k >= 0; --k)
+        if (dep[u] - (1 << k) >= dep[v])
+            u = up[u][k];
+    if (u == v)
+        return u;
+    for (int k = LOG; k >= 0; --k)
+        if (up[u][k] != up[v][k])
+            u = up[u][k], v = up[v][k];
+    return up[u][0];
+}
+
+int32_t main() {
+    for (int shape = 0; shape < 3; ++shape)
+        for (int n : {1, 2, 3, 10, 1000})
+            random_trees(n, shape);
+    random_trees(1 << 17, 0);
+    random_trees(1 << 17, 1);  // a path: deep enough to overflow recursion
+    scanning();
+
+    constexpr int n = 1 << 20, q = 1 << 22;
+    auto parent = random_parents(n, 0, 0);
+    vector<pair<uint32_t, uint32_t>> queries(q);
+    for (auto& [u, v] : queries)
+        u = rand(0, n - 1), v = rand(0, n - 1);
+
+    auto start1 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    adj.assign(n, {});
+    for (int v = 1; v < n; ++v)
+        adj[parent[v]].push_back(v), adj[v].push_back(parent[v]);
+    up.resize(n);
+    dep.assign(n, 0);
+    lifting_dfs(0, 0);
+    auto start2 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    long long lifting_sum = 0;
+    for (auto [u, v] : queries)
+        lifting_sum += lifting_lca(u, v);
+    auto start3 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    tree t(parent);
+    auto start4 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    long long single_sum = 0;
+    for (auto [u, v] : queries)
+        single_sum += t.lca(u, v);
+    auto start5 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    auto answers = t.lca(queries);
+    auto start6 = chrono::high_resolution_clock::now().time_since_epoch().count();
+    assert(lifting_sum == single_sum &&
+           single_sum == accumulate(answers.begin(), answers.end(), 0ll));
+
+    auto lifting = (start3 - start2) / 1e6, single = (start5 - start4) / 1e6,
+         batch = (start6 - start5) / 1e6;
+    printf("With %d vertices and %d queries:\n", n, q);
+    printf("build: binary lifting %.5f ms, cpdsa::tree %.5f ms\n",
+           (start2 - start1) / 1e6, (start4 - start3) / 1e6);
+    printf("lca  : binary lifting %.5f ms, cpdsa::tree %.5f ms (%.5fx faster), "
+           "batched %.5f ms (%.5fx faster)\n\n",
+           lifting, single, lifting / single, batch, lifting / batch);
+}